@@ -1,107 +1,82 @@
 // Bresenham.cpp
 // Advanced implementation using Object-Oriented Programming and modularity
 // Draws multiple lines from the center outward to form a star/radial pattern.
+//
+// --bits keeps the canvas as a 1-bit-per-cell mask (../common/bit_canvas.h):
+// runs are filled a 64-bit word at a time and the cell count and bounding
+// box come from popcounts and bit scans. --rle keeps it as per-row runs
+// (../common/run_canvas.h), which cost memory only for what is drawn.
+// --tiles [W H] draws on a sparse canvas of 256x256 tiles allocated on
+// first touch (../common/sparse_canvas.h), so W and H can be a million or
+// more; only the tiles the rays cross take memory. Either way chars appear
+// only when displayed, and canvases too wide to print are summarized.
+//
+//   g++ -O2 -std=c++17 -pthread Bresenham.cpp -o Bresenham
+//   ./Bresenham --bits
+//   ./Bresenham --tiles 1000000 1000000
 
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <string>
+#include <algorithm>
 #include <stdexcept>
+#include "../common/char_canvas.h"
 using namespace std;
 
-// Canvas dimensions (for virtual grid)
+// Canvas dimensions (for virtual grid); --tiles can override them
 const int WIDTH = 40;
 const int HEIGHT = 20;
 
-// Canvas class to simulate plotting in a 2D matrix
-class Canvas {
-private:
-    vector<vector<char>> grid;
-
-public:
-    Canvas(int width, int height) {
-        grid.resize(height, vector<char>(width, '.'));  // initialize with dots
-    }
-
-    void plotPoint(int x, int y, char symbol = '*') {
-        if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT) {
-            grid[HEIGHT - y - 1][x] = symbol;  // invert y for correct display
-        }
-    }
-
-    void display() {
-        for (const auto& row : grid) {
-            for (char c : row) {
-                cout << c << " ";
-            }
-            cout << endl;
-        }
-    }
-
-    void clear() {
-        for (auto& row : grid) {
-            fill(row.begin(), row.end(), '.');
-        }
-    }
-};
-
-// LineDrawer class encapsulates Bresenham's algorithm
-class LineDrawer {
-private:
-    Canvas& canvas;
-
-public:
-    LineDrawer(Canvas& c) : canvas(c) {}
-
-    void drawLine(int x1, int y1, int x2, int y2, char symbol = '*') {
-        int dx = abs(x2 - x1);
-        int dy = abs(y2 - y1);
-        int sx = (x1 < x2) ? 1 : -1;
-        int sy = (y1 < y2) ? 1 : -1;
-        int err = dx - dy;
-
-        while (true) {
-            canvas.plotPoint(x1, y1, symbol);
-
-            if (x1 == x2 && y1 == y2) break;
-
-            int e2 = 2 * err;
-            if (e2 > -dy) { err -= dy; x1 += sx; }
-            if (e2 < dx)  { err += dx; y1 += sy; }
-        }
-    }
-};
-
-// Function to draw a radial star from center with N rays
-void drawRadialStar(LineDrawer& drawer, int cx, int cy, int rays) {
+// Function to draw a radial star from center with N rays, reaching 0.45
+// of the canvas size (18 x 9 cells on the default 40 x 20 canvas)
+void drawRadialStar(LineDrawer& drawer, int cx, int cy, int rays, double rx, double ry) {
     double angleStep = 360.0 / rays;
 
     for (int i = 0; i < rays; ++i) {
         double angle = angleStep * i * M_PI / 180.0;
-        int x = cx + static_cast<int>(cos(angle) * 18);  // radius ~18
-        int y = cy + static_cast<int>(sin(angle) * 9);   // aspect ratio adjust
+        int x = cx + static_cast<int>(cos(angle) * rx);
+        int y = cy + static_cast<int>(sin(angle) * ry);   // aspect ratio adjust
 
         drawer.drawLine(cx, cy, x, y, '#');
     }
 }
 
 // Main program
-int main() {
+int main(int argc, char** argv) {
     try {
-        Canvas canvas(WIDTH, HEIGHT);
+        CanvasMode mode = CanvasMode::Chars;
+        int width = WIDTH, height = HEIGHT;
+        if (argc > 1 && string(argv[1]) == "--bits") mode = CanvasMode::Bits;
+        if (argc > 1 && string(argv[1]) == "--rle") mode = CanvasMode::Runs;
+        if (argc > 1 && string(argv[1]) == "--tiles") {
+            mode = CanvasMode::Tiles;
+            if (argc > 3) { width = stoi(argv[2]); height = stoi(argv[3]); }
+            if (width <= 0 || height <= 0) throw invalid_argument("Invalid canvas size.");
+        }
+        Canvas canvas(width, height, '.', mode);
         LineDrawer drawer(canvas);
 
-        int centerX = WIDTH / 2;
-        int centerY = HEIGHT / 2;
+        int centerX = width / 2;
+        int centerY = height / 2;
         int numRays;
 
         cout << "Enter number of rays for the radial star (e.g., 12 or 24): ";
         cin >> numRays;
         if (numRays <= 0 || numRays > 360) throw invalid_argument("Invalid number of rays.");
 
-        drawRadialStar(drawer, centerX, centerY, numRays);
+        drawRadialStar(drawer, centerX, centerY, numRays, width * 9.0 / 20, height * 9.0 / 20);
 
         cout << "\nRadial star pattern:\n";
         canvas.display();
+
+        BitRect box;
+        cout << "\nCells drawn: " << canvas.countSet();
+        if (canvas.boundingBox(box))
+            cout << ", bounding box x " << box.x0 << ".." << box.x1 - 1 << ", y " << box.y0 << ".." << box.y1 - 1;
+        cout << endl;
+        if (mode == CanvasMode::Tiles)
+            cout << "Tiles touched: " << canvas.tileCount() << ", " << canvas.tileBytes() / 1024 << " KB" << endl;
     } catch (const exception& e) {
         cerr << "Error: " << e.what() << endl;
     }
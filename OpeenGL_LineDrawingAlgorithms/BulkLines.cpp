@@ -0,0 +1,115 @@
+// BulkLines.cpp
+// Plots millions of line segments into one grayscale image with
+// ../common/line_batch.h, the way datashader-style bulk plots do: random-
+// walk time series (short segments) or random chords (long ones). Each
+// strategy is timed, the cost model's choice is printed, and all
+// strategies must produce the same image. The image is written as PGM or
+// PNG (../common/image_stream.h; PNG is only deflated with -DENABLE_ZLIB
+// -lz, otherwise stored uncompressed).
+//
+//   g++ -O2 -std=c++17 -pthread BulkLines.cpp -o BulkLines
+//   ./BulkLines [segments] [size] [threads] [series|chords] [out.pgm|out.png]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include "../common/line_batch.h"
+#include "../common/image_stream.h"
+using namespace std;
+
+const char* strategyName(LineStrategy s) {
+    switch (s) {
+      case LineStrategy::Serial: return "serial";
+      case LineStrategy::Tiled: return "tiled";
+      case LineStrategy::Private: return "private";
+      default: return "auto";
+    }
+}
+
+// Random walks across the image, one segment per sample
+vector<LineSegment> makeSeries(size_t count, int size, mt19937 &rng) {
+    vector<LineSegment> segs;
+    segs.reserve(count);
+    normal_distribution<float> noise(0.0f, size / 200.0f);
+    uniform_real_distribution<float> start(0.0f, float(size - 1));
+    int samples = size;                          // one series spans the width
+    while (segs.size() < count) {
+        float y = start(rng), prevY = y;
+        for (int x = 1; x < samples && segs.size() < count; ++x) {
+            y = min(max(y + noise(rng), 0.0f), float(size - 1));
+            segs.push_back({ x - 1, int(prevY), x, int(y) });
+            prevY = y;
+        }
+    }
+    return segs;
+}
+
+// Chords between random points
+vector<LineSegment> makeChords(size_t count, int size, mt19937 &rng) {
+    vector<LineSegment> segs(count);
+    uniform_int_distribution<int> coord(0, size - 1);
+    for (auto &s : segs) s = { coord(rng), coord(rng), coord(rng), coord(rng) };
+    return segs;
+}
+
+void saveImage(const string &filename, const vector<uint8_t> &image, int size, TileScheduler &scheduler) {
+    ImageStreamWriter out(filename, size, size, 1, &scheduler);
+    for (int y = size - 1; y >= 0; --y)          // row 0 is the bottom
+        out.writeRows(image.data() + (size_t)y * size, 1, size);
+    out.finish();
+}
+
+int main(int argc, char **argv) {
+    try {
+        size_t count = argc > 1 ? stoull(argv[1]) : 2000000;
+        int size = argc > 2 ? stoi(argv[2]) : 2048;
+        int threads = argc > 3 ? stoi(argv[3]) : 0;
+        string kind = argc > 4 ? argv[4] : "series";
+        string outFile = argc > 5 ? argv[5] : "";
+        if (size <= 1 || (kind != "series" && kind != "chords")) throw invalid_argument("Invalid arguments.");
+
+        mt19937 rng(2024);
+        vector<LineSegment> segs = kind == "series" ? makeSeries(count, size, rng) : makeChords(count, size, rng);
+
+        TileScheduler scheduler(threads);
+        LineBatchRenderer serial, parallel(&scheduler);
+        serial.resize(size, size);
+        parallel.resize(size, size);
+
+        LineBatchStats stats;
+        parallel.chooseStrategy(segs.data(), segs.size(), &stats);
+        cout << segs.size() << " " << kind << " segments, " << size << "x" << size << ", "
+             << scheduler.workerCount() + 1 << " threads, mean length " << fixed << setprecision(1)
+             << stats.averageLength << " px\n";
+        cout << "model overhead: tiled " << setprecision(1) << stats.tiledOverheadMs << " ms, private "
+             << stats.privateOverheadMs << " ms -> " << strategyName(stats.strategy) << "\n\n";
+
+        vector<uint8_t> reference((size_t)size * size, 0), image((size_t)size * size);
+        bool allSame = true;
+        for (LineMerge mode : { LineMerge::Max, LineMerge::Or }) {
+            cout << (mode == LineMerge::Max ? "coverage (max)\n" : "mask (or)\n");
+            for (LineStrategy s : { LineStrategy::Serial, LineStrategy::Tiled, LineStrategy::Private }) {
+                LineBatchRenderer &r = s == LineStrategy::Serial ? serial : parallel;
+                vector<uint8_t> &out = s == LineStrategy::Serial ? reference : image;
+                fill(out.begin(), out.end(), 0);
+                auto t0 = chrono::steady_clock::now();
+                r.draw(segs.data(), segs.size(), mode, out.data(), 0xFF, s);
+                double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+                bool same = out == reference;
+                allSame &= same;
+                cout << "  " << left << setw(10) << strategyName(s) << right << setw(10) << setprecision(1) << ms
+                     << " ms" << (same ? "" : "   MISMATCH") << (s == stats.strategy ? "   <- chosen" : "") << "\n";
+            }
+            if (mode == LineMerge::Max && !outFile.empty()) saveImage(outFile, reference, size, scheduler);
+        }
+        if (!outFile.empty()) cout << "\nSaved " << outFile << "\n";
+        return allSame ? 0 : 1;
+    } catch (const exception &e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+}
@@ -1,6 +1,11 @@
+#define GL_GLEXT_PROTOTYPES   // shader entry points for sdf_shapes.h
 #include <GL/glut.h>
 #include <iostream>
 #include <cmath>
+#include "../../../common/headless.h"
+#include "../../../common/frame_profiler.h"
+#include "../../../common/sdf_shapes.h"
+#include "../../../common/stroke.h"
 
 // Conversion factor: 1 centimeter = 0.1 OpenGL units.
 const float CM_TO_GL = 0.1f;
@@ -10,11 +15,46 @@ const float centerX = 1.0f;  // Circle center x-coordinate (starting point)
 const float centerY = 1.0f;  // Circle center y-coordinate (starting point)
 const float circleRadius = 4.0f * CM_TO_GL;  // 4 centimeters
 
+// --sdf: draw the filled circle as one anti-aliased quad instead of a fan
+bool useSdf = false;
+SdfRenderer sdf;
+
+// Orthographic view and the window size it maps to
+const float viewLeft = -1.0f, viewRight = 1.5f, viewBottom = -1.0f, viewTop = 1.5f;
+int viewWidth = 500, viewHeight = 500;
+
+// Axes (1.5 px) are stroked on the CPU, so their width does not depend on
+// glLineWidth support; rebuilt when the window size changes
+StrokeMesh xAxisStroke, yAxisStroke;
+
+uint64_t viewKey() {
+    const float view[6] = { viewLeft, viewRight, viewBottom, viewTop, (float)viewWidth, (float)viewHeight };
+    return strokeHash(view, sizeof(view));
+}
+
+void drawMesh(const StrokeMesh& m) {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, m.vertices.data());
+    glDrawElements(GL_TRIANGLES, (GLsizei)m.indices.size(), GL_UNSIGNED_INT, m.indices.data());
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+// One 1.5 px axis from (x0, y0) to (x1, y1)
+void drawAxis(StrokeMesh& mesh, float x0, float y0, float x1, float y1) {
+    if (mesh.begin(StrokeStyle{ 1.5f }, viewKey())) {
+        mesh.setPixelScale(viewWidth / (viewRight - viewLeft), viewHeight / (viewTop - viewBottom));
+        mesh.addSegment(x0, y0, x1, y1);
+        mesh.end();
+    }
+    drawMesh(mesh);
+}
+
 // Utility: Draw a string using GLUT bitmap fonts at a given raster position.
 void drawString(void *font, const char* str, float x, float y) {
+    PROFILE_SCOPE("drawString");
     glRasterPos2f(x, y);
     for (const char* c = str; *c != '\0'; c++) {
-        glutBitmapCharacter(font, *c);
+        bitmapCharacter(font, *c);
     }
 }
 
@@ -52,6 +92,7 @@ void plotCirclePoints(int x, int y) {
 
 // Bresenham's circle drawing algorithm.
 void drawCircle() {
+    PROFILE_SCOPE("drawCircle");
     int x = 0;
     // Calculate the radius in integer “cm grid units” (should be 4).
     int y = static_cast<int>(circleRadius / CM_TO_GL);
@@ -75,6 +116,11 @@ void drawCircle() {
 // Draw a filled circle using a triangle fan.
 // (This function approximates the filled circle and is used after applying the rotation.)
 void drawFilledCircle() {
+    PROFILE_SCOPE("drawFilledCircle");
+    if (useSdf) {
+        sdf.draw(SdfShape{ centerX, centerY, circleRadius, circleRadius, 0.0f });
+        return;
+    }
     const int numSegments = 100; // Increase for a smoother circle approximation
     glBegin(GL_TRIANGLE_FAN);
         // Center of circle
@@ -92,21 +138,14 @@ void drawFilledCircle() {
 // ---------------------------------------------------------------------
 // Draw coordinate axes with distinct colors and label them.
 void drawAxes() {
-    glLineWidth(1.5f);
-    
+    PROFILE_SCOPE("drawAxes");
     // Draw X-axis in blue.
     glColor3f(0.0f, 0.0f, 1.0f);  
-    glBegin(GL_LINES);
-        glVertex2f(-1.0f, 0.0f);
-        glVertex2f(1.5f, 0.0f);
-    glEnd();
+    drawAxis(xAxisStroke, viewLeft, 0.0f, viewRight, 0.0f);
     
     // Draw Y-axis in green.
     glColor3f(0.0f, 0.5f, 0.0f);  
-    glBegin(GL_LINES);
-        glVertex2f(0.0f, -1.0f);
-        glVertex2f(0.0f, 1.5f);
-    glEnd();
+    drawAxis(yAxisStroke, 0.0f, viewBottom, 0.0f, viewTop);
 
     // Label the axes with black text.
     glColor3f(0.0f, 0.0f, 0.0f);
@@ -117,6 +156,7 @@ void drawAxes() {
 // ---------------------------------------------------------------------
 // Mark and label the circle's center (starting point) for clarity.
 void drawCenterLabel() {
+    PROFILE_SCOPE("drawCenterLabel");
     glPointSize(6.0f);
     glColor3f(0.5f, 0.0f, 0.5f);  // Purple color for the center
     glBegin(GL_POINTS);
@@ -133,6 +173,7 @@ void drawCenterLabel() {
 // 1. The original circle outline drawn using Bresenham's algorithm.
 // 2. The rotated (60° clockwise) filled circle.
 void display() {
+    PROFILE_SCOPE("display");
     glClear(GL_COLOR_BUFFER_BIT);
     
     drawAxes();
@@ -161,6 +202,7 @@ void display() {
     
     drawCenterLabel();
     
+    PROFILE_FRAME_END();
     glFlush();
 }
 
@@ -171,12 +213,28 @@ void init() {
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
     // Adjust the orthographic projection to include the circle and axes.
-    gluOrtho2D(-1.0, 1.5, -1.0, 1.5);
+    gluOrtho2D(viewLeft, viewRight, viewBottom, viewTop);
+    if (useSdf && !sdf.init()) useSdf = false;
+}
+
+// ---------------------------------------------------------------------
+// Window resize: the projection stays, the axis strokes follow the new size.
+void reshape(int width, int height) {
+    glViewport(0, 0, width, height);
+    viewWidth = width;
+    viewHeight = height;
 }
 
 // ---------------------------------------------------------------------
 // Main function: initialize GLUT, set up callbacks, and start the main loop.
 int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--sdf") useSdf = true;
+
+    HeadlessOptions headless(500, 500);
+    if (parseHeadlessArgs(argc, argv, headless))
+        return runHeadless(headless, init, reshape, display);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(500, 500);
@@ -184,6 +242,7 @@ int main(int argc, char** argv) {
     
     init();
     glutDisplayFunc(display);
+    glutReshapeFunc(reshape);
     glutMainLoop();
     
     return 0;
@@ -2,9 +2,13 @@
 // OpenGL Program: Draw a Triangle and Its Circumscribed Circle
 // ======================================================
 
+#define GL_GLEXT_PROTOTYPES   // shader entry points for sdf_shapes.h
 #include <GL/glut.h>
 #include <cmath>
 #include <iostream>
+#include "../../../../common/headless.h"
+#include "../../../../common/frame_profiler.h"
+#include "../../../../common/sdf_shapes.h"
 
 // Define constant PI for angle calculations
 #define PI 3.14159265358979323846
@@ -24,6 +28,10 @@ Point A = { -1.0f, 6.0f };
 Point B = {  2.0f, 0.0f };
 Point C = { -4.0f, 9.0f };
 
+// --sdf: draw the circle as one quad shaded from its distance (anti-aliased)
+bool useSdf = false;
+SdfRenderer sdf;
+
 // ---------------------------------------------------------------------
 // Function: computeCircumcenter
 // Purpose: Given three points (forming a triangle), this function
@@ -52,9 +60,10 @@ Point computeCircumcenter(Point A, Point B, Point C) {
 // Purpose: Draws a string at a given (x,y) location using GLUT bitmap fonts.
 // ---------------------------------------------------------------------
 void renderBitmapString(float x, float y, void *font, const char* string) {
+    PROFILE_SCOPE("renderBitmapString");
     glRasterPos2f(x, y);
     for (const char* c = string; *c != '\0'; c++) {
-        glutBitmapCharacter(font, *c);
+        bitmapCharacter(font, *c);
     }
 }
 
@@ -64,6 +73,7 @@ void renderBitmapString(float x, float y, void *font, const char* string) {
 // across a wide range. Axes help in understanding the coordinate system.
 // ---------------------------------------------------------------------
 void drawAxes() {
+    PROFILE_SCOPE("drawAxes");
     // X-axis in green
     glColor3f(0.0f, 1.0f, 0.0f);
     glBegin(GL_LINES);
@@ -90,6 +100,7 @@ void drawAxes() {
 // "Think Pause": We choose GL_LINE_LOOP so the triangle is outlined.
 // ---------------------------------------------------------------------
 void drawTriangle() {
+    PROFILE_SCOPE("drawTriangle");
     // Set a distinct color (magenta) for the triangle outline
     glColor3f(1.0f, 0.0f, 1.0f);
     glBegin(GL_LINE_LOOP);
@@ -112,20 +123,26 @@ void drawTriangle() {
 // "Think Pause": We use GL_LINE_LOOP with many segments to approximate a smooth circle.
 // ---------------------------------------------------------------------
 void drawCircumcircle(Point center, float radius) {
+    PROFILE_SCOPE("drawCircumcircle");
     // Set the drawing color to red (RGB: 1.0, 0.0, 0.0)
     glColor3f(1.0f, 0.0f, 0.0f);
-    int num_segments = 200;  // Increase for smoother appearance
-    glBegin(GL_LINE_LOOP);
-    for (int i = 0; i < num_segments; i++) {
-        // Calculate the angle for this segment
-        float theta = 2.0f * PI * float(i) / float(num_segments);
-        // Compute (x,y) position on the circle's circumference
-        float x = radius * cosf(theta);
-        float y = radius * sinf(theta);
-        // Specify the vertex (translated by the circle's center)
-        glVertex2f(center.x + x, center.y + y);
+    if (useSdf) {
+        // 1-pixel outline, 4 vertices instead of 200
+        sdf.draw(SdfShape{ center.x, center.y, radius, radius, 1.0f });
+    } else {
+        int num_segments = 200;  // Increase for smoother appearance
+        glBegin(GL_LINE_LOOP);
+        for (int i = 0; i < num_segments; i++) {
+            // Calculate the angle for this segment
+            float theta = 2.0f * PI * float(i) / float(num_segments);
+            // Compute (x,y) position on the circle's circumference
+            float x = radius * cosf(theta);
+            float y = radius * sinf(theta);
+            // Specify the vertex (translated by the circle's center)
+            glVertex2f(center.x + x, center.y + y);
+        }
+        glEnd();
     }
-    glEnd();
     
     // Optionally, mark the circle's center with a label "O"
     glColor3f(0.0f, 0.0f, 0.0f);
@@ -138,6 +155,7 @@ void drawCircumcircle(Point center, float radius) {
 // draw axes, the triangle, compute the circumcenter, and draw the circumcircle.
 // ---------------------------------------------------------------------
 void display() {
+    PROFILE_SCOPE("display");
     glClear(GL_COLOR_BUFFER_BIT);
     
     // 1. Draw coordinate axes for reference.
@@ -157,6 +175,7 @@ void display() {
     // 4. Draw the circumcircle in red.
     drawCircumcircle(center, radius);
     
+    PROFILE_FRAME_END();
     glFlush();
 }
 
@@ -175,12 +194,29 @@ void reshape(int width, int height) {
     glLoadIdentity();
 }
 
+// ---------------------------------------------------------------------
+// Function: init
+// Purpose: One-time OpenGL state (shared by the windowed and headless paths).
+// ---------------------------------------------------------------------
+void init() {
+    // Set the background to white.
+    glClearColor(1.0, 1.0, 1.0, 1.0);
+    if (useSdf && !sdf.init()) useSdf = false;
+}
+
 // ---------------------------------------------------------------------
 // Function: main
 // Purpose: Standard GLUT initialization, creating the window, and
 // registering the callback functions.
 // ---------------------------------------------------------------------
 int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--sdf") useSdf = true;
+
+    HeadlessOptions headless(800, 600);
+    if (parseHeadlessArgs(argc, argv, headless))
+        return runHeadless(headless, init, reshape, display);
+
     glutInit(&argc, argv);
     // Use single buffering and RGB color mode.
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
@@ -188,8 +224,7 @@ int main(int argc, char** argv) {
     glutInitWindowPosition(100, 100);
     glutCreateWindow("Triangle and Its Circumcircle");
     
-    // Set the background to white.
-    glClearColor(1.0, 1.0, 1.0, 1.0);
+    init();
     
     // Register the display and reshape callback functions.
     glutDisplayFunc(display);
@@ -1,7 +1,9 @@
 #include <GL/glut.h>
 #include <cmath>
-#include <stack>
 #include <iostream>
+#include "../../../../common/frame_arena.h"
+#include "../../../../common/headless.h"
+#include "../../../../common/frame_profiler.h"
 
 const int windowWidth = 600, windowHeight = 600;
 float leftCoord = -10.0f, rightCoord = 10.0f;
@@ -9,6 +11,7 @@ float bottomCoord = -10.0f, topCoord = 10.0f;
 
 // **Function to draw coordinate axes**
 void drawAxes() {
+    PROFILE_SCOPE("drawAxes");
     glColor3f(0.0f, 1.0f, 0.0f);  // Green X-axis
     glBegin(GL_LINES);
     glVertex2f(leftCoord, 0.0f); glVertex2f(rightCoord, 0.0f);
@@ -22,6 +25,7 @@ void drawAxes() {
 
 // **Function to draw an ellipse using the Midpoint Algorithm**
 void drawEllipse() {
+    PROFILE_SCOPE("drawEllipse");
     int rx = 6, ry = 5;  
     int xc = 2, yc = -1; 
 
@@ -75,7 +79,12 @@ bool colorMatch(const float c1[3], const float c2[3]) {
 
 // **Iterative Flood-Fill Algorithm (Stack-based, 4-connected)**
 void floodFill(int x, int y, const float fillColor[3], const float borderColor[3]) {
-    std::stack<std::pair<int, int>> pixelStack;
+    PROFILE_SCOPE("floodFill");
+    // Pending pixels live in the frame arena; a generous reserve keeps the
+    // vector from leaving abandoned smaller copies behind as it grows
+    FrameVector<std::pair<int, int>> storage(&frameArena());
+    storage.reserve(4096);
+    FrameStack<std::pair<int, int>> pixelStack(std::move(storage));
     pixelStack.push({x, y});
 
     while (!pixelStack.empty()) {
@@ -113,6 +122,7 @@ int worldToWindowY(float y) {
 
 // **Display Function**
 void display() {
+    PROFILE_SCOPE("display");
     glClear(GL_COLOR_BUFFER_BIT);
 
     drawAxes();
@@ -143,7 +153,9 @@ void display() {
     glMatrixMode(GL_MODELVIEW);
     glPopMatrix();
 
-    glutSwapBuffers();
+    FRAME_ARENA_END();
+    PROFILE_FRAME_END();
+    presentFrame(true);
 }
 
 // **Reshape Function**
@@ -164,6 +176,10 @@ void init() {
 
 // **Main Function**
 int main(int argc, char** argv) {
+    HeadlessOptions headless(windowWidth, windowHeight);
+    if (parseHeadlessArgs(argc, argv, headless))
+        return runHeadless(headless, init, reshape, display);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(windowWidth, windowHeight);
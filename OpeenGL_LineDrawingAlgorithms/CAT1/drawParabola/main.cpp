@@ -1,35 +1,68 @@
 #include <GL/glut.h>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <string>
+#include <vector>
+#include "../../../common/headless.h"
+#include "../../../common/frame_profiler.h"
+#include "../../../common/curve_tess.h"
+#include "../../../common/conic_raster.h"
+#include "../../../common/stroke.h"
 
 // Window settings
 const int windowWidth = 600, windowHeight = 600;
 float leftCoord = -10.0f, rightCoord = 10.0f;
 float bottomCoord = -10.0f, topCoord = 10.0f;
+int viewWidth = windowWidth, viewHeight = windowHeight;
+
+// x = y^2 for y in [-3, 3], tessellated to a quarter pixel at the current
+// zoom (+/- keys) and cached per zoom level
+CachedCurve<QuadBezier> parabola(parabolaX(1, 0, 0, -3, 3));
+
+// --raster: draw it instead as the exact pixels of the integer midpoint
+// conic rasterizer, one rectangle per span
+bool useRaster = false;
+struct Span { int y, x0, x1; };
+std::vector<Span> parabolaSpans;
+
+// Axes (1.5 px) and curve (2 px) are stroked on the CPU, so their width
+// does not depend on glLineWidth support; rebuilt when the view changes
+StrokeMesh axesStroke, parabolaStroke;
+
+uint64_t viewKey() {
+    const float view[6] = { leftCoord, rightCoord, bottomCoord, topCoord, (float)viewWidth, (float)viewHeight };
+    return strokeHash(view, sizeof(view));
+}
+
+void drawMesh(const StrokeMesh& m) {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, m.vertices.data());
+    glDrawElements(GL_TRIANGLES, (GLsizei)m.indices.size(), GL_UNSIGNED_INT, m.indices.data());
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
 
 // Function to render text at a given position
 void drawText(const char* text, float x, float y) {
+    PROFILE_SCOPE("drawText");
     glRasterPos2f(x, y);
     while (*text) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *text);
+        bitmapCharacter(GLUT_BITMAP_HELVETICA_12, *text);
         text++;
     }
 }
 
 // Function to draw axes with labels
 void drawAxes() {
+    PROFILE_SCOPE("drawAxes");
     glColor3f(0, 0, 0);  // Black color for axes
-    glLineWidth(1.5);
-    
-    glBegin(GL_LINES);
-        // X-axis
-        glVertex2f(leftCoord, 0);
-        glVertex2f(rightCoord, 0);
-        
-        // Y-axis
-        glVertex2f(0, bottomCoord);
-        glVertex2f(0, topCoord);
-    glEnd();
+    if (axesStroke.begin(StrokeStyle{ 1.5f }, viewKey())) {
+        axesStroke.setPixelScale(viewWidth / (rightCoord - leftCoord), viewHeight / (topCoord - bottomCoord));
+        axesStroke.addSegment(leftCoord, 0, rightCoord, 0);   // X-axis
+        axesStroke.addSegment(0, bottomCoord, 0, topCoord);   // Y-axis
+        axesStroke.end();
+    }
+    drawMesh(axesStroke);
 
     // Labels for axes
     drawText("+X", rightCoord - 1.0f, 0.5f);
@@ -41,29 +74,71 @@ void drawAxes() {
 
 // Function to draw a smooth parabola x = y^2
 void drawParabola() {
+    PROFILE_SCOPE("drawParabola");
     glColor3f(1, 0, 0);  // Red color for the curve
-    glLineWidth(2.0);
 
-    glBegin(GL_LINE_STRIP);  // Using GL_LINE_STRIP for a smooth curve
-
-    for (float y = -3.0f; y <= 3.0f; y += 0.05f) { // Smaller step for smoothness
-        float x = y * y;
-        glVertex2f(x, y);
+    StrokeStyle style;
+    style.width = 2.0f;
+    style.join = StrokeJoin::Round;   // smooth at every tessellation vertex
+    if (parabolaStroke.begin(style, viewKey())) {
+        CurveView view = CurveView::fromOrtho(leftCoord, rightCoord, bottomCoord, topCoord, viewWidth, viewHeight);
+        const std::vector<CurvePoint>& points = parabola.points(view);
+        parabolaStroke.setPixelScale(view.pxPerUnitX, view.pxPerUnitY);
+        parabolaStroke.addPolyline(points.data(), points.size());
+        parabolaStroke.end();
     }
+    drawMesh(parabolaStroke);
+}
 
+// Function to draw x = y^2 as pixel spans
+void drawParabolaSpans() {
+    PROFILE_SCOPE("drawParabolaSpans");
+    const float view[4] = { leftCoord, rightCoord, bottomCoord, topCoord };
+    IntConic conic = RealConic::parabolaX(1, 0, 0).toPixels(view, viewWidth, viewHeight).quantize(viewWidth, viewHeight);
+    auto toPixel = [&](float x, float y) {
+        return ConicPixel{ (int)std::floor((x - leftCoord) / (rightCoord - leftCoord) * viewWidth),
+                           (int)std::floor((y - bottomCoord) / (topCoord - bottomCoord) * viewHeight) };
+    };
+    // Visible part of y in [-3, 3]: the trace must start and end on screen
+    float reach = std::sqrt(std::max(rightCoord, 0.0f));
+    float y0 = std::max({ -3.0f, bottomCoord, -reach }), y1 = std::min({ 3.0f, topCoord, reach });
+    parabolaSpans.clear();
+    if (y0 > y1) return;
+    // From the bottom end through the vertex to the top end: clockwise
+    // around the inside (x > y^2)
+    rasterConic(conic, toPixel(y0 * y0, y0), toPixel(y1 * y1, y1), -1, { 0, 0, viewWidth, viewHeight },
+                [](int y, int x0, int x1) { parabolaSpans.push_back({ y, x0, x1 }); });
+
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, viewWidth, 0, viewHeight);
+    glColor3f(1, 0, 0);  // Red color for the curve
+    glBegin(GL_QUADS);
+    for (const Span& s : parabolaSpans) {
+        glVertex2i(s.x0, s.y); glVertex2i(s.x1, s.y);
+        glVertex2i(s.x1, s.y + 1); glVertex2i(s.x0, s.y + 1);
+    }
     glEnd();
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
 }
 
 // Display function
 void display() {
+    PROFILE_SCOPE("display");
     glClear(GL_COLOR_BUFFER_BIT);
     drawAxes();
-    drawParabola();
+    if (useRaster) drawParabolaSpans();
+    else drawParabola();
+    PROFILE_FRAME_END();
     glFlush();
 }
 
 // Reshape function
 void reshape(int w, int h) {
+    viewWidth = w;
+    viewHeight = h;
     glViewport(0, 0, w, h);
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -71,6 +146,18 @@ void reshape(int w, int h) {
     glMatrixMode(GL_MODELVIEW);
 }
 
+// Zoom in/out around the origin
+void keyboard(unsigned char key, int, int) {
+    float factor = key == '+' || key == '=' ? 0.8f : key == '-' ? 1.25f : 0.0f;
+    if (factor == 0.0f) return;
+    leftCoord *= factor; rightCoord *= factor;
+    bottomCoord *= factor; topCoord *= factor;
+    reshape(viewWidth, viewHeight);
+    CurveView view = CurveView::fromOrtho(leftCoord, rightCoord, bottomCoord, topCoord, viewWidth, viewHeight);
+    std::cout << "Zoom " << 10.0f / rightCoord << "x: " << parabola.points(view).size() << " vertices\n";
+    glutPostRedisplay();
+}
+
 // Initialization
 void init() {
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -78,6 +165,13 @@ void init() {
 
 // Main function
 int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--raster") useRaster = true;
+
+    HeadlessOptions headless(windowWidth, windowHeight);
+    if (parseHeadlessArgs(argc, argv, headless))
+        return runHeadless(headless, init, reshape, display);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(windowWidth, windowHeight);
@@ -86,6 +180,7 @@ int main(int argc, char** argv) {
     init();
     glutDisplayFunc(display);
     glutReshapeFunc(reshape);
+    glutKeyboardFunc(keyboard);
     glutMainLoop();
     return 0;
 }
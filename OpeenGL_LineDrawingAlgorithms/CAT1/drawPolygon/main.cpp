@@ -1,11 +1,35 @@
+#define GL_GLEXT_PROTOTYPES   // glWindowPos2i for the --aa blit
 #include <GL/glut.h>
+#include <algorithm>
+#include <string>
 #include <vector>
+#include "../../../common/headless.h"
+#include "../../../common/frame_profiler.h"
+#include "../../../common/poly_clip.h"
+#include "../../../common/coverage_raster.h"
 
 // Define polygon vertices
 std::vector<std::pair<float, float>> polygonVertices = {
     {8, 4}, {2, 4}, {0, 8}, {3, 12}, {7, 12}, {10, 8}
 };
 
+// Polygons are placed (scale, translate) on the CPU and clipped there
+// against the view of gluOrtho2D(-20, 20, -20, 20), or with --clip-window
+// against a convex octagon, so off-screen parts never reach the driver.
+const float VIEW[4] = { -20, 20, -20, 20 };
+const float clipWindowX[8] = { -16, -11, 13, 18, 18, 13, -11, -16 };
+const float clipWindowY[8] = { -11, -16, -16, -11, 14, 19, 19, 14 };
+bool useClipWindow = false;
+PolygonClipper clipper;
+ClipBatch placedPolygons, clippedPolygons;
+
+// --aa: fill them anti-aliased from exact per-pixel area coverage
+// (even-odd, like isInsidePolygon) instead of with GL_POLYGON
+bool useCoverage = false;
+CoverageRasterizer coverage;
+ClipBatch pixelPolygons;
+std::vector<uint8_t> coverageImage;   // RGBA, whole window
+
 // Function to check if a point is inside the polygon (Even-Odd Rule Algorithm)
 bool isInsidePolygon(float x, float y) {
     int count = 0;
@@ -24,6 +48,7 @@ bool isInsidePolygon(float x, float y) {
 
 // Function to fill the polygon with green asterisks
 void fillPolygonWithAsterisks() {
+    PROFILE_SCOPE("fillPolygonWithAsterisks");
     glColor3f(0.0, 0.8, 0.0); // Green color
     glRasterPos2f(0, 0);
     
@@ -31,58 +56,138 @@ void fillPolygonWithAsterisks() {
         for (float x = 0; x <= 10; x += 0.5) {
             if (isInsidePolygon(x, y)) {
                 glRasterPos2f(x, y);
-                glutBitmapCharacter(GLUT_BITMAP_9_BY_15, '*');
+                bitmapCharacter(GLUT_BITMAP_9_BY_15, '*');
             }
         }
     }
 }
 
-// Function to draw the polygon outline
-void drawPolygon() {
+// Queue the polygon scaled by 'scale' and moved by (tx, ty)
+void placePolygon(float scale, float tx, float ty) {
+    placedPolygons.beginPolygon();
+    for (auto& v : polygonVertices)
+        placedPolygons.vertex(v.first * scale + tx, v.second * scale + ty);
+    placedPolygons.endPolygon();
+}
+
+// Function to draw the clipped polygons
+void drawPolygons(const ClipBatch& polygons) {
+    PROFILE_SCOPE("drawPolygons");
     glColor3f(1.0, 0.0, 0.0); // Red color
-    glBegin(GL_POLYGON);
-    for (auto& v : polygonVertices) {
-        glVertex2f(v.first, v.second);
+    for (size_t p = 0; p < polygons.polygonCount(); ++p) {
+        uint32_t first = polygons.firstVertex[p], last = first + polygons.vertexCount[p];
+        glBegin(GL_POLYGON);
+        for (uint32_t i = first; i < last; ++i) {
+            glVertex2f(polygons.x[i], polygons.y[i]);
+        }
+        glEnd();
     }
-    glEnd();
 }
 
-// Function to draw the scaled polygon
-void drawScaledPolygon() {
-    glPushMatrix();
-    glScalef(2.0, 2.0, 1.0); // Scale by a factor of 2
-    drawPolygon();
-    glPopMatrix();
+// Function to draw the clipped polygons anti-aliased
+void drawPolygonsAA(const ClipBatch& polygons) {
+    PROFILE_SCOPE("drawPolygonsAA");
+    GLint vp[4];
+    glGetIntegerv(GL_VIEWPORT, vp);
+    int w = vp[2], h = vp[3];
+    if (coverage.canvasWidth() != w || coverage.canvasHeight() != h) {
+        coverage.resize(w, h);
+        coverageImage.assign((size_t)w * h * 4, 0);
+    }
+
+    // World to pixel units
+    float sx = w / (VIEW[1] - VIEW[0]), sy = h / (VIEW[3] - VIEW[2]);
+    pixelPolygons = polygons;
+    for (float& x : pixelPolygons.x) x = (x - VIEW[0]) * sx;
+    for (float& y : pixelPolygons.y) y = (y - VIEW[2]) * sy;
+    coverage.addPolygons(pixelPolygons);
+
+    // Red with coverage as alpha, into the rows' touched ranges
+    int x0 = w, y0 = h, x1 = 0, y1 = 0;
+    coverage.resolve(FillRule::EvenOdd, [&](int y, int first, const uint8_t* alpha, int count) {
+        uint8_t* px = coverageImage.data() + ((size_t)y * w + first) * 4;
+        for (int i = 0; i < count; ++i, px += 4) {
+            px[0] = 255; px[1] = 0; px[2] = 0; px[3] = alpha[i];
+        }
+        x0 = std::min(x0, first); x1 = std::max(x1, first + count);
+        y0 = std::min(y0, y); y1 = std::max(y1, y + 1);
+    });
+    if (x0 >= x1) return;
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, w);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, x0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, y0);
+    glWindowPos2i(x0, y0);
+    glDrawPixels(x1 - x0, y1 - y0, GL_RGBA, GL_UNSIGNED_BYTE, coverageImage.data());
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glDisable(GL_BLEND);
+
+    // Transparent again for the next frame
+    for (int y = y0; y < y1; ++y)
+        std::fill(coverageImage.begin() + ((size_t)y * w + x0) * 4, coverageImage.begin() + ((size_t)y * w + x1) * 4, 0);
+}
+
+// Function to draw the clip window outline
+void drawClipWindow() {
+    glColor3f(0.0, 0.0, 1.0); // Blue color
+    glBegin(GL_LINE_LOOP);
+    for (int i = 0; i < 8; ++i) {
+        glVertex2f(clipWindowX[i], clipWindowY[i]);
+    }
+    glEnd();
 }
 
 // Display function
 void display() {
+    PROFILE_SCOPE("display");
     glClear(GL_COLOR_BUFFER_BIT);
 
-    // Draw original polygon with fill
-    glPushMatrix();
-    glTranslatef(-5, -5, 0); // Adjust position for visibility
-    drawPolygon();
-    fillPolygonWithAsterisks(); // Fill interior with green asterisks
-    glPopMatrix();
+    // Original polygon, moved for visibility, and the polygon scaled by 2
+    // and moved right (partly off-screen), clipped as one batch
+    placedPolygons.clear();
+    placePolygon(1.0f, -5, -5);
+    placePolygon(2.0f, 15, 0);
+    {
+        PROFILE_SCOPE("clipPolygons");
+        clipper.clip(placedPolygons, clippedPolygons);
+    }
+    if (useCoverage) drawPolygonsAA(clippedPolygons);
+    else drawPolygons(clippedPolygons);
 
-    // Draw scaled polygon
+    // Fill interior of the original polygon with green asterisks
     glPushMatrix();
-    glTranslatef(15, 0, 0); // Move right for better view
-    drawScaledPolygon();
+    glTranslatef(-5, -5, 0);
+    fillPolygonWithAsterisks();
     glPopMatrix();
 
+    if (useClipWindow) drawClipWindow();
+
+    PROFILE_FRAME_END();
     glFlush();
 }
 
 // Initialize OpenGL settings
 void init() {
     glClearColor(1, 1, 1, 1); // White background
-    gluOrtho2D(-20, 20, -20, 20); // Coordinate system
+    gluOrtho2D(VIEW[0], VIEW[1], VIEW[2], VIEW[3]); // Coordinate system
+    if (useClipWindow) clipper.setConvex(clipWindowX, clipWindowY, 8);
+    else clipper.setRect(VIEW[0], VIEW[1], VIEW[2], VIEW[3]);
 }
 
 // Main function
 int main(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i)
+        if (std::string(argv[i]) == "--clip-window") useClipWindow = true;
+        else if (std::string(argv[i]) == "--aa") useCoverage = true;
+
+    HeadlessOptions headless(800, 800);
+    if (parseHeadlessArgs(argc, argv, headless))
+        return runHeadless(headless, init, nullptr, display);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(800, 800);
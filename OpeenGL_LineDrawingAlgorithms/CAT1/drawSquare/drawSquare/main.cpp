@@ -1,16 +1,19 @@
 #include <GL/glut.h>
 #include <cmath>
-#include <sstream>
-#include <string>
+#include <string_view>
+#include "../../../../common/frame_arena.h"
+#include "../../../../common/headless.h"
+#include "../../../../common/frame_profiler.h"
 
 #define PI 3.14159265
 #define DEG_TO_RAD(angle) ((angle) * PI / 180.0)
 
 // Function to render text at given coordinates
-void renderText(float x, float y, std::string text) {
+void renderText(float x, float y, std::string_view text) {
+    PROFILE_SCOPE("renderText");
     glRasterPos2f(x, y);
     for (char c : text) {
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, c);
+        bitmapCharacter(GLUT_BITMAP_HELVETICA_12, c);
     }
 }
 
@@ -27,7 +30,8 @@ void rotatePoint(float x, float y, float cx, float cy, float theta, float &newX,
 
 // Function to draw a square and label its points
 void drawSquare(float x1, float y1, float x2, float y2, 
-                float x3, float y3, float x4, float y4, std::string label) {
+                float x3, float y3, float x4, float y4, const char* label) {
+    PROFILE_SCOPE("drawSquare");
     glBegin(GL_LINE_LOOP);
         glVertex2f(x1, y1);
         glVertex2f(x2, y2);
@@ -35,15 +39,18 @@ void drawSquare(float x1, float y1, float x2, float y2,
         glVertex2f(x4, y4);
     glEnd();
 
-    // Label the coordinates
-    renderText(x1, y1, label + "A(" + std::to_string((int)x1) + "," + std::to_string((int)y1) + ")");
-    renderText(x2, y2, label + "B(" + std::to_string((int)x2) + "," + std::to_string((int)y2) + ")");
-    renderText(x3, y3, label + "C(" + std::to_string((int)x3) + "," + std::to_string((int)y3) + ")");
-    renderText(x4, y4, label + "D(" + std::to_string((int)x4) + "," + std::to_string((int)y4) + ")");
+    // Label the coordinates (strings live in the frame arena)
+    const float corners[4][2] = { {x1, y1}, {x2, y2}, {x3, y3}, {x4, y4} };
+    for (int i = 0; i < 4; ++i) {
+        FrameString text(&frameArena());
+        appendText(text, label, char('A' + i), "(", (int)corners[i][0], ",", (int)corners[i][1], ")");
+        renderText(corners[i][0], corners[i][1], text);
+    }
 }
 
 // Function to draw coordinate axes
 void drawAxes() {
+    PROFILE_SCOPE("drawAxes");
     glBegin(GL_LINES);
         glColor3f(0.0, 0.0, 0.0); // Black axes
         glVertex2f(-10, 0); glVertex2f(10, 0); // X-axis
@@ -52,6 +59,7 @@ void drawAxes() {
 }
 
 void display() {
+    PROFILE_SCOPE("display");
     glClear(GL_COLOR_BUFFER_BIT);
     drawAxes(); // Draw reference axes
 
@@ -76,6 +84,8 @@ void display() {
     glColor3f(0.0, 1.0, 0.0);
     drawSquare(x1, y1, x2, y2, x3, y3, x4, y4, "R");
 
+    FRAME_ARENA_END();
+    PROFILE_FRAME_END();
     glFlush();
 }
 
@@ -85,6 +95,10 @@ void init() {
 }
 
 int main(int argc, char** argv) {
+    HeadlessOptions headless(600, 600);
+    if (parseHeadlessArgs(argc, argv, headless))
+        return runHeadless(headless, init, nullptr, display);
+
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
     glutInitWindowSize(600, 600);
@@ -0,0 +1,99 @@
+// ClipCheck.cpp
+// Checks the polygon clipper of ../common/poly_clip.h. One PolygonClipper
+// clips batches of random polygons with 0, then 2, then 1 attribute
+// channels (the scratch buffers must follow the channel count from batch
+// to batch), against a rectangle and a convex octagon. Each attribute is
+// a linear function of the position, so after interpolation it must
+// still match the function at every clipped vertex; every vertex must lie
+// inside the region, and the output must equal that of a fresh clipper.
+// Exits with 1 on any failure.
+//
+//   g++ -O2 -std=c++17 ClipCheck.cpp -o ClipCheck
+//   ./ClipCheck [polygons] [seed]
+
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "../common/poly_clip.h"
+using namespace std;
+
+// Attribute k at (x, y)
+float attributeAt(int k, float x, float y) { return (k + 1) * x - (2 * k - 1) * y + k; }
+
+// Random star-shaped polygons around points of [-30, 30]^2, some of them
+// reaching past the clip region
+ClipBatch randomBatch(int polygons, int attributes, mt19937& rng) {
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    ClipBatch batch(attributes);
+    for (int p = 0; p < polygons; ++p) {
+        float cx = 60 * unit(rng) - 30, cy = 60 * unit(rng) - 30, r = 1 + 15 * unit(rng);
+        int n = 3 + (int)(10 * unit(rng));
+        batch.beginPolygon();
+        for (int i = 0; i < n; ++i) {
+            float angle = 6.2831853f * (i + 0.8f * unit(rng)) / n, radius = r * (0.4f + 0.6f * unit(rng));
+            float x = cx + radius * cosf(angle), y = cy + radius * sinf(angle), a[CLIP_MAX_ATTRIBUTES];
+            for (int k = 0; k < attributes; ++k) a[k] = attributeAt(k, x, y);
+            batch.vertex(x, y, a);
+        }
+        batch.endPolygon();
+    }
+    return batch;
+}
+
+bool sameBatch(const ClipBatch& a, const ClipBatch& b) {
+    return a.x == b.x && a.y == b.y && a.attr == b.attr &&
+           a.firstVertex == b.firstVertex && a.vertexCount == b.vertexCount;
+}
+
+// Every vertex inside the region (to rounding) and every attribute on
+// its linear function
+bool validClip(const ClipBatch& out, const vector<ClipPlane>& planes) {
+    for (size_t i = 0; i < out.vertexTotal(); ++i) {
+        float x = out.x[i], y = out.y[i], scale = 1 + fabsf(x) + fabsf(y);
+        for (const ClipPlane& p : planes)
+            if (p.a * x + p.b * y + p.c < -1e-4f * scale * (fabsf(p.a) + fabsf(p.b) + 1)) return false;
+        for (int k = 0; k < out.attributeCount(); ++k)
+            if (fabsf(out.attr[k][i] - attributeAt(k, x, y)) > 1e-3f * scale * (k + 2)) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    unsigned seed = argc > 2 ? (unsigned)strtoul(argv[2], nullptr, 10) : 7;
+    mt19937 rng(seed);
+    bool allGood = true;
+
+    const float octX[8] = { 20, 14, 0, -14, -20, -14, 0, 14 }, octY[8] = { 0, 14, 20, 14, 0, -14, -20, -14 };
+    const vector<ClipPlane> rectPlanes = { { 1, 0, 20 }, { -1, 0, 20 }, { 0, 1, 20 }, { 0, -1, 20 } };
+    vector<ClipPlane> octPlanes;
+    for (int i = 0; i < 8; ++i) {
+        int j = (i + 1) % 8;
+        float a = -(octY[j] - octY[i]), b = octX[j] - octX[i];
+        octPlanes.push_back({ a, b, -(a * octX[i] + b * octY[i]) });
+    }
+
+    for (int region = 0; region < 2; ++region) {
+        PolygonClipper reused;
+        if (region == 0) reused.setRect(-20, 20, -20, 20);
+        else reused.setConvex(octX, octY, 8);
+        for (int attributes : { 0, 2, 1 }) {
+            ClipBatch in = randomBatch(count, attributes, rng), out, fresh;
+            reused.clip(in, out);
+            PolygonClipper once;
+            if (region == 0) once.setRect(-20, 20, -20, 20);
+            else once.setConvex(octX, octY, 8);
+            once.clip(in, fresh);
+            bool ok = out.attributeCount() == attributes && sameBatch(out, fresh) &&
+                      validClip(out, region == 0 ? rectPlanes : octPlanes);
+            cout << (region == 0 ? "rectangle" : "octagon") << ", " << attributes << " attribute(s): "
+                 << in.polygonCount() << " polygons in, " << out.polygonCount() << " out, "
+                 << (ok ? "ok" : "MISMATCH") << "\n";
+            allGood &= ok;
+        }
+    }
+    cout << (allGood ? "all good" : "FAILED") << "\n";
+    return allGood ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// ConicCheck.cpp
+// Checks the conic tracer of ../common/conic_raster.h. Circles of integer
+// radius 1..2000, traced both ways round, must give exactly the pixels of
+// the integer midpoint circle algorithm. Random rotated ellipses, most
+// of them thin (minor semi-axis 0.3 to 4.3 pixels, so the tips curve far
+// tighter than a pixel), must close from a random start, with every
+// pixel within one pixel of the curve and no gap along it; random
+// parabola and hyperbola arcs must reach their end pixel the same way.
+// Exits with 1 on any failure.
+//
+//   g++ -O2 -std=c++17 ConicCheck.cpp -o ConicCheck
+//   ./ConicCheck [ellipses] [seed]
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <set>
+#include <utility>
+#include "../common/conic_raster.h"
+using namespace std;
+
+typedef set<pair<int, int>> PixelSet;
+
+// Pixels of rasterConic, and its return value
+PixelSet trace(const IntConic& c, ConicPixel from, ConicPixel to, int orientation, int64_t& result) {
+    PixelSet pixels;
+    result = rasterConic(c, from, to, orientation, { -100000, -100000, 100000, 100000 },
+                         [&](int y, int x0, int x1) { for (int x = x0; x < x1; ++x) pixels.insert({ x, y }); });
+    return pixels;
+}
+
+// The integer midpoint circle, all eight octants
+PixelSet midpointCircle(int r) {
+    PixelSet pixels;
+    int x = 0, y = r, d = 1 - r;
+    while (x <= y) {
+        int points[8][2] = { { x, y }, { y, x }, { -x, y }, { -y, x }, { x, -y }, { y, -x }, { -x, -y }, { -y, -x } };
+        for (auto& p : points) pixels.insert({ p[0], p[1] });
+        if (d < 0) d += 2 * x + 3;
+        else { d += 2 * (x - y) + 5; --y; }
+        ++x;
+    }
+    return pixels;
+}
+
+// Traced pixels against the curve sampled densely at parameters [t0, t1]:
+// each pixel within one pixel (either axis) of a sample, and each
+// sample's pixel within one pixel of a traced one
+bool followsCurve(const PixelSet& pixels, double t0, double t1, const function<ConicPixel(double)>& at) {
+    const int SAMPLES = 8000;
+    PixelSet near;
+    bool covered = true;
+    for (int i = 0; i <= SAMPLES; ++i) {
+        ConicPixel p = at(t0 + (t1 - t0) * i / SAMPLES);
+        bool hit = false;
+        for (int dy = -1; dy <= 1; ++dy)
+            for (int dx = -1; dx <= 1; ++dx) {
+                near.insert({ p.x + dx, p.y + dy });
+                hit = hit || pixels.count({ p.x + dx, p.y + dy });
+            }
+        covered = covered && hit;
+    }
+    if (!covered) return false;
+    for (auto& p : pixels)
+        if (!near.count(p)) return false;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 2000;
+    unsigned seed = argc > 2 ? (unsigned)strtoul(argv[2], nullptr, 10) : 7;
+    bool allGood = true;
+    auto start = chrono::steady_clock::now();
+
+    // Circles: x^2 + y^2 - r^2, exact
+    int circleBad = 0;
+    for (int r = 1; r <= 2000; ++r)
+        for (int o = -1; o <= 1; o += 2) {
+            IntConic c = { 1, 0, 1, 0, 0, -(int64_t)r * r, 8192 };
+            int64_t result;
+            PixelSet pixels = trace(c, { r, 0 }, { r, 0 }, o, result);
+            if (result < 0 || pixels != midpointCircle(r)) {
+                if (circleBad++ < 4) cout << "circle r=" << r << " orientation " << o << ": MISMATCH\n";
+            }
+        }
+    cout << "circles r = 1..2000, both ways: " << circleBad << " mismatches\n";
+    allGood &= circleBad == 0;
+
+    // Rotated ellipses in a 1000x1000 view of [0, 1000]^2 (pixel (x, y)
+    // covers world [x, x + 1) x [y, y + 1))
+    const int SIZE = 1000;
+    const float view[4] = { 0, (float)SIZE, 0, (float)SIZE };
+    mt19937 rng(seed);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    auto pixelOf = [](double x, double y) { return ConicPixel{ (int)floor(x), (int)floor(y) }; };
+    int ellipseBad = 0;
+    for (int i = 0; i < count; ++i) {
+        double cx = 200 + 600 * unit(rng), cy = 200 + 600 * unit(rng);
+        double a = 2 + 150 * unit(rng), b = 0.3 + 4 * unit(rng), angle = 6.2832 * unit(rng), t0 = 6.2832 * unit(rng);
+        int o = i & 1 ? 1 : -1;
+        auto at = [&](double t) {
+            double u = a * cos(t), v = b * sin(t);
+            return pixelOf(cx + u * cos(angle) - v * sin(angle), cy + u * sin(angle) + v * cos(angle));
+        };
+        IntConic c = RealConic::rotatedEllipse(cx, cy, a, b, angle).toPixels(view, SIZE, SIZE).quantize(SIZE, SIZE);
+        int64_t result;
+        PixelSet pixels = trace(c, at(t0), at(t0), o, result);
+        if (result < 0 || !followsCurve(pixels, 0, 6.2832, at)) {
+            if (ellipseBad++ < 4)
+                cout << "ellipse a=" << a << " b=" << b << " angle=" << angle << ": " << (result < 0 ? "FAILED" : "OFF CURVE") << "\n";
+        }
+    }
+    cout << "rotated ellipses: " << count << ", " << ellipseBad << " bad\n";
+    allGood &= ellipseBad == 0;
+
+    // Parabola x = p*y^2 + q*y + s (clockwise round x > ..., going up) and
+    // right hyperbola branches (counter-clockwise, going up), in views of
+    // random size and zoom, between two on-screen points
+    int arcs = 0, arcBad = 0;
+    for (int i = 0; i < count; ++i) {
+        int w = 200 + (int)(1800 * unit(rng)), h = 200 + (int)(1800 * unit(rng));
+        double half = 0.5 + 20 * unit(rng), vx = half * (2 * unit(rng) - 1), vy = half * (2 * unit(rng) - 1);
+        float v[4] = { (float)(vx - half), (float)(vx + half), (float)(vy - half * h / w), (float)(vy + half * h / w) };
+        bool hyperbola = i & 1;
+        double p = 0.1 + 3 * unit(rng), q = 2 * unit(rng) - 1, s = 4 * unit(rng) - 2;
+        double hx = 4 * unit(rng) - 2, hy = 4 * unit(rng) - 2, ha = 0.2 + 3 * unit(rng), hb = 0.2 + 3 * unit(rng);
+        double t0 = -2 + 1.9 * unit(rng), t1 = 0.1 + 1.9 * unit(rng);
+        RealConic conic = hyperbola ? RealConic::hyperbola(hx, hy, ha, hb) : RealConic::parabolaX(p, q, s);
+        auto at = [&](double t) {
+            double x = hyperbola ? hx + ha * cosh(t) : p * t * t + q * t + s;
+            double y = hyperbola ? hy + hb * sinh(t) : t;
+            return pixelOf((x - v[0]) / (v[1] - v[0]) * w, (y - v[2]) / (v[3] - v[2]) * h);
+        };
+        ConicPixel from = at(t0), to = at(t1);
+        if (from.x < 0 || from.x >= w || from.y < 0 || from.y >= h || to.x < 0 || to.x >= w || to.y < 0 || to.y >= h) continue;
+        ++arcs;
+        IntConic c = conic.toPixels(v, w, h).quantize(w, h);
+        int64_t result;
+        PixelSet pixels = trace(c, from, to, hyperbola ? 1 : -1, result);
+        if (result < 0 || !followsCurve(pixels, t0, t1, at)) {
+            if (arcBad++ < 4) cout << (hyperbola ? "hyperbola" : "parabola") << " arc " << i << ": " << (result < 0 ? "FAILED" : "OFF CURVE") << "\n";
+        }
+    }
+    cout << "parabola and hyperbola arcs: " << arcs << ", " << arcBad << " bad\n";
+    allGood &= arcBad == 0;
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    cout << (allGood ? "all good" : "FAILED") << " (" << ms << " ms)\n";
+    return allGood ? 0 : 1;
+}
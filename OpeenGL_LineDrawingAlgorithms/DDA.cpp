@@ -2,80 +2,52 @@
 // Advanced DDA line-drawing tool with rotation and file output
 // Author: Kitavi Douglas Kimani
 // Date: 2025-05-07
+//
+// --bits keeps each canvas as a 1-bit-per-cell mask (../common/bit_canvas.h),
+// --rle as per-row runs (../common/run_canvas.h), converted to chars only
+// when displayed. With --rle the shapes are saved run-length encoded
+// (.rle); --decode turns such a file back into the dense text format.
+// --tiles [W H] uses a sparse canvas of 256x256 tiles allocated on first
+// touch (../common/sparse_canvas.h) instead of a dense W x H one, with the
+// pentagon scaled to fit, so W and H can be a million or more; canvases
+// too wide to print are summarized and not saved as text.
+// --export pgm|ppm|png also writes original_shape.<ext> and
+// rotated_shape.<ext> through ../common/image_stream.h: rows are read off
+// the canvas a band at a time and streamed out, so even a --tiles canvas
+// of gigapixels is never copied whole. PNG is compressed (on all cores)
+// only in a -DENABLE_ZLIB build; the plain build writes it uncompressed,
+// one byte per pixel. Text saves go through the same buffered writer a
+// row at a time.
+//
+//   g++ -O2 -std=c++17 -pthread DDA.cpp -o DDA                     # PNG uncompressed
+//   g++ -O2 -std=c++17 -pthread -DENABLE_ZLIB DDA.cpp -o DDA -lz   # deflated PNG
+//   ./DDA --rle
+//   ./DDA --tiles 1000000 1000000
+//   ./DDA --tiles 40000 40000 --export png
+//   ./DDA --decode rotated_shape.rle rotated_shape.txt
 
 #include <iostream>
 #include <vector>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
+#include <string>
+#include <algorithm>
 #include <stdexcept>
+#include "../common/frame_arena.h"
+#include "../common/char_canvas.h"
 using namespace std;
 
-// Virtual canvas
-class Canvas {
-    int width, height;
-    vector<string> grid;
-    char bg;
-
-public:
-    Canvas(int w, int h, char bgSym = '.') 
-      : width(w), height(h), bg(bgSym), grid(h, string(w, bgSym)) {}
-
-    void plot(int x, int y, char sym = '#') {
-        if (x>=0 && x<width && y>=0 && y<height)
-            grid[height - 1 - y][x] = sym;
-    }
-
-    void clear() {
-        for (auto &row : grid) row.assign(width, bg);
-    }
-
-    void display() const {
-        for (auto &row : grid) {
-            for (char c : row) cout << c << ' ';
-            cout << '\n';
-        }
-    }
-
-    void save(const string &filename) const {
-        ofstream ofs(filename);
-        if (!ofs) throw runtime_error("Cannot open file: " + filename);
-        for (auto &row : grid) {
-            for (char c : row) ofs << c << ' ';
-            ofs << '\n';
-        }
-    }
-};
-
-// DDA drawer
-class DDALineDrawer {
-    Canvas &canvas;
-public:
-    DDALineDrawer(Canvas &c) : canvas(c) {}
-
-    void draw(int x0, int y0, int x1, int y1, char sym='#') {
-        int dx = x1 - x0, dy = y1 - y0;
-        int steps = max(abs(dx), abs(dy));
-        if (steps == 0) { canvas.plot(x0,y0,sym); return; }
-
-        float xInc = float(dx)/steps;
-        float yInc = float(dy)/steps;
-        float x = x0, y = y0;
-
-        for (int i = 0; i <= steps; ++i) {
-            canvas.plot(int(round(x)), int(round(y)), sym);
-            x += xInc;  y += yInc;
-        }
-    }
-};
-
 // 2D point
 struct Point {
     float x, y;
 };
 
+// Vertex lists are transient: they live in the frame arena
+typedef FrameVector<Point> PointList;
+
 // Compute centroid of polygon
-Point centroid(const vector<Point> &pts) {
+Point centroid(const PointList &pts) {
     float cx = 0, cy = 0;
     for (auto &p : pts) { cx += p.x; cy += p.y; }
     int n = pts.size();
@@ -93,7 +65,7 @@ Point rotatePt(const Point &p, float angRad, const Point &origin) {
 }
 
 // Draw a polygon (closed shape)
-void drawPolygon(DDALineDrawer &drawer, const vector<Point> &pts, char sym) {
+void drawPolygon(DDALineDrawer &drawer, const PointList &pts, char sym) {
     int n = pts.size();
     for (int i = 0; i < n; ++i) {
         auto &A = pts[i], &B = pts[(i+1)%n];
@@ -102,15 +74,43 @@ void drawPolygon(DDALineDrawer &drawer, const vector<Point> &pts, char sym) {
     }
 }
 
-int main() {
+int main(int argc, char **argv) {
     const int W = 60, H = 30;
-    Canvas canvasOrig(W,H), canvasRot(W,H);
+    // --export <ext> may come anywhere; the rest are positional
+    string exportExt;
+    vector<string> args;
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--export" && i + 1 < argc) exportExt = argv[++i];
+        else args.push_back(argv[i]);
+    }
+    string flag = args.empty() ? "" : args[0];
+    if (flag == "--decode") {
+        if (args.size() != 3) { cerr << "usage: " << argv[0] << " --decode <in.rle> <out.txt>\n"; return 1; }
+        try {
+            Canvas::loadRLE(args[1]).saveText(args[2]);
+        } catch (const exception &e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+        cout << "Decoded " << args[1] << " to " << args[2] << "\n";
+        return 0;
+    }
+    CanvasMode mode = flag == "--bits" ? CanvasMode::Bits : flag == "--rle" ? CanvasMode::Runs : CanvasMode::Chars;
+    int width = W, height = H;
+    if (flag == "--tiles") {
+        mode = CanvasMode::Tiles;
+        if (args.size() > 2) { width = atoi(args[1].c_str()); height = atoi(args[2].c_str()); }
+        if (width <= 0 || height <= 0) { cerr << "Invalid canvas size\n"; return 1; }
+    }
+    Canvas canvasOrig(width,height,'.',mode), canvasRot(width,height,'.',mode);
     DDALineDrawer drawerOrig(canvasOrig), drawerRot(canvasRot);
 
-    // Sample polygon: a pentagon
-    vector<Point> polygon = {
+    // Sample polygon: a pentagon, scaled with the canvas from its 60 x 30 layout
+    PointList polygon({
         {10, 5}, {20, 5}, {25, 15}, {15, 25}, {5, 15}
-    };
+    }, &frameArena());
+    float scale = min(float(width) / W, float(height) / H);
+    for (auto &p : polygon) { p.x *= scale; p.y *= scale; }
 
     // Compute centroid and set rotation angle
     Point cen = centroid(polygon);
@@ -122,8 +122,9 @@ int main() {
     // Draw original
     drawPolygon(drawerOrig, polygon, '*');
 
-    // Compute rotated vertices
-    vector<Point> rotated;
+    // Compute rotated vertices (sized once, no regrowth)
+    PointList rotated(&frameArena());
+    rotated.reserve(polygon.size());
     for (auto &p : polygon)
         rotated.push_back(rotatePt(p, angRad, cen));
 
@@ -131,15 +132,38 @@ int main() {
     drawPolygon(drawerRot, rotated, '#');
 
     // Display side by side
-    cout << "\nOriginal Polygon:\n";
-    canvasOrig.display();
-    cout << "\nRotated Polygon (" << angleDegrees << "°):\n";
-    canvasRot.display();
-
-    // Save to files
-    canvasOrig.save("original_shape.txt");
-    canvasRot.save("rotated_shape.txt");
-    cout << "\nSaved frames to original_shape.txt and rotated_shape.txt\n";
+    if (canvasOrig.printable()) {
+        cout << "\nOriginal Polygon:\n";
+        canvasOrig.display();
+        cout << "\nRotated Polygon (" << angleDegrees << "°):\n";
+        canvasRot.display();
+    }
+    cout << "\nCells drawn: " << canvasOrig.countSet() << " original, " << canvasRot.countSet() << " rotated\n";
+    if (mode == CanvasMode::Tiles)
+        cout << "Tiles touched: " << canvasOrig.tileCount() + canvasRot.tileCount() << ", "
+             << (canvasOrig.tileBytes() + canvasRot.tileBytes()) / 1024 << " KB\n";
+
+    try {
+        if (!exportExt.empty()) {
+            TileScheduler sched;
+            canvasOrig.exportImage("original_shape." + exportExt, &sched);
+            canvasRot.exportImage("rotated_shape." + exportExt, &sched);
+            cout << "\nExported original_shape." << exportExt << " and rotated_shape." << exportExt << "\n";
+        }
+        if (!canvasOrig.printable()) {
+            cout << "(" << width << "x" << height << " canvases, too wide to print or save as text)\n";
+            return 0;
+        }
+
+        // Save to files
+        string ext = mode == CanvasMode::Runs ? ".rle" : ".txt";
+        canvasOrig.save("original_shape" + ext);
+        canvasRot.save("rotated_shape" + ext);
+        cout << "\nSaved frames to original_shape" << ext << " and rotated_shape" << ext << "\n";
+    } catch (const exception &e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
 
     return 0;
 }
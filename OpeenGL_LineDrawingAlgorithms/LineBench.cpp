@@ -0,0 +1,271 @@
+// LineBench.cpp
+// Times the anti-aliased line algorithms two ways on the same random
+// lines: the runtime version (the steep test inside the loop on every
+// plot, pixels sent through a virtual sink) and the templated kernels of
+// ../common/line_kernels.h (octant and plot policy fixed at compile time,
+// dispatched once per line). Both must produce the same pixels, which
+// is checked on every run. A second table compares the float Wu kernel
+// with the fixed-point one on integer endpoints, which must agree within
+// one step of 8-bit coverage.
+//
+//   g++ -O2 -std=c++17 LineBench.cpp -o LineBench
+//   ./LineBench [lines] [canvas size]
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <chrono>
+#include <random>
+#include <string>
+#include "../common/line_kernels.h"
+using namespace std;
+
+// === Runtime versions ===
+// Any output, one virtual call per pixel
+struct PixelSink {
+    virtual void plot(int x, int y, float c) = 0;
+    virtual void endLine() {}
+    virtual ~PixelSink() {}
+};
+
+// Wu with the steep test on every plot, as in XiaolinWu.cpp before the kernels
+void wuRuntime(float x0, float y0, float x1, float y1, PixelSink& out) {
+    using namespace line_detail;
+    bool steep = fabs(y1 - y0) > fabs(x1 - x0);
+    if (steep) { swap(x0, y0); swap(x1, y1); }
+    if (x0 > x1) { swap(x0, x1); swap(y0, y1); }
+    float dx = x1 - x0, dy = y1 - y0;
+    float gradient = dx == 0.0f ? 1.0f : dy / dx;
+
+    float xend = round(x0);
+    float yend = y0 + gradient * (xend - x0);
+    float xgap = rfpart(x0 + 0.5f);
+    int xpxl1 = int(xend), ypxl1 = ipart(yend);
+    out.plot(steep ? ypxl1 : xpxl1, steep ? xpxl1 : ypxl1, rfpart(yend) * xgap);
+    out.plot(steep ? ypxl1 + 1 : xpxl1, steep ? xpxl1 : ypxl1 + 1, fpart(yend) * xgap);
+    float intery0 = yend - float(ypxl1);
+
+    xend = round(x1);
+    yend = y1 + gradient * (xend - x1);
+    xgap = fpart(x1 + 0.5f);
+    int xpxl2 = int(xend), ypxl2 = ipart(yend);
+
+    for (int x = xpxl1 + 1; x < xpxl2; x++) {
+        float intery = intery0 + gradient * float(x - xpxl1);
+        int base = ipart(intery);
+        float f = intery - float(base);
+        base += ypxl1;
+        out.plot(steep ? base : x, steep ? x : base, 1.0f - f);
+        out.plot(steep ? base + 1 : x, steep ? x : base + 1, f);
+    }
+    out.plot(steep ? ypxl2 : xpxl2, steep ? xpxl2 : ypxl2, rfpart(yend) * xgap);
+    out.plot(steep ? ypxl2 + 1 : xpxl2, steep ? xpxl2 : ypxl2 + 1, fpart(yend) * xgap);
+    out.endLine();
+}
+
+// Gupta-Sproull with the steep and direction tests in the loop
+void gsRuntime(int x0, int y0, int x1, int y1, PixelSink& out, float lineWidth = 1.0f) {
+    using namespace line_detail;
+    int dx = abs(x1 - x0), dy = abs(y1 - y0);
+    int sx = x1 >= x0 ? 1 : -1, sy = y1 >= y0 ? 1 : -1;
+    bool steep = dy > dx;
+    if (steep) { swap(x0, y0); swap(x1, y1); swap(dx, dy); swap(sx, sy); }
+    float gradient = dx == 0 ? 0.0f : float(dy) / dx;
+    float intery = y0 + sy * gradient;
+    int x = x0;
+
+    out.plot(steep ? y0 : x, steep ? x : y0, 1.0f);
+    for (int i = 1; i <= dx; i++) {
+        x += sx;
+        float base = floor(intery);
+        float d = intery - base;
+        int b = int(base);
+        out.plot(steep ? b : x, steep ? x : b, gsIntensity(d, lineWidth));
+        out.plot(steep ? b + 1 : x, steep ? x : b + 1, gsIntensity(1.0f - d, lineWidth));
+        intery += sy * gradient;
+    }
+    out.plot(steep ? y1 : x1, steep ? x1 : y1, 1.0f);
+    out.endLine();
+}
+
+// Sinks matching the kernel policies
+struct CanvasSink : PixelSink {
+    CanvasPlot p;
+    explicit CanvasSink(CanvasPlot c) : p(c) {}
+    void plot(int x, int y, float c) override { p(x, y, c); }
+};
+struct BlendSink : PixelSink {
+    CoverageBlendPlot p;
+    explicit BlendSink(CoverageBlendPlot c) : p(c) {}
+    void plot(int x, int y, float c) override { p(x, y, c); }
+};
+struct SpanCounter {
+    uint64_t* spans;
+    uint64_t* pixels;
+    void operator()(int, int x0, int x1) const { ++*spans; *pixels += x1 - x0; }
+};
+struct SpanSink : PixelSink {
+    SpanPlot<SpanCounter> p;
+    explicit SpanSink(SpanCounter c) : p(c) {}
+    void plot(int x, int y, float c) override { p(x, y, c); }
+    void endLine() override { p.flush(); }
+};
+struct CountSink : PixelSink {
+    CountPlot p;
+    void plot(int x, int y, float c) override { p(x, y, c); }
+};
+
+// === Benchmark ===
+struct Line {
+    float x0, y0, x1, y1;
+};
+
+uint64_t checksum(const vector<uint8_t>& pixels) {
+    uint64_t h = 1469598103934665603ull;
+    for (uint8_t v : pixels) h = (h ^ v) * 1099511628211ull;
+    return h;
+}
+
+template <class F>
+double seconds(F&& f) {
+    auto t0 = chrono::steady_clock::now();
+    f();
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+void report(const string& name, double runtime, double templated, size_t lines, bool same) {
+    cout << left << setw(26) << name << right << fixed << setprecision(2)
+         << setw(10) << lines / runtime / 1e6 << setw(12) << lines / templated / 1e6
+         << setw(9) << runtime / templated << "x" << (same ? "" : "   MISMATCH") << endl;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 20000;
+    int size = argc > 2 ? atoi(argv[2]) : 1024;
+
+    mt19937 rng(12345);
+    uniform_real_distribution<float> coord(0.0f, float(size - 1));
+    vector<Line> lines(count);
+    for (Line& l : lines) l = { coord(rng), coord(rng), coord(rng), coord(rng) };
+
+    vector<uint8_t> a((size_t)size * size), b((size_t)size * size);
+    bool allSame = true;
+
+    cout << "lines: " << count << ", canvas " << size << "x" << size << "\n\n";
+    cout << left << setw(26) << "algorithm / policy" << right << setw(10) << "runtime" << setw(12) << "templated"
+         << setw(10) << "speedup" << "\n" << setw(26) << "" << setw(22) << "(million lines/s)" << "\n";
+
+    for (int algo = 0; algo < 2; ++algo) {
+        string prefix = algo == 0 ? "Wu / " : "Gupta-Sproull / ";
+        auto runtimeAll = [&](PixelSink& sink) {
+            for (const Line& l : lines) {
+                if (algo == 0) wuRuntime(l.x0, l.y0, l.x1, l.y1, sink);
+                else gsRuntime(int(l.x0), int(l.y0), int(l.x1), int(l.y1), sink);
+            }
+        };
+        auto templatedAll = [&](auto& plot, auto&& endLine) {
+            for (const Line& l : lines) {
+                if (algo == 0) drawWuLine(l.x0, l.y0, l.x1, l.y1, plot);
+                else drawGuptaSproullLine(int(l.x0), int(l.y0), int(l.x1), int(l.y1), plot);
+                endLine();
+            }
+        };
+        auto nothing = [] {};
+
+        // Canvas write
+        {
+            fill(a.begin(), a.end(), 0); fill(b.begin(), b.end(), 0);
+            CanvasSink sink({ a.data(), size, size });
+            CanvasPlot plot = { b.data(), size, size };
+            double r = seconds([&] { runtimeAll(sink); });
+            double t = seconds([&] { templatedAll(plot, nothing); });
+            bool same = checksum(a) == checksum(b);
+            allSame &= same;
+            report(prefix + "canvas", r, t, count, same);
+        }
+        // Coverage blend
+        {
+            fill(a.begin(), a.end(), 0); fill(b.begin(), b.end(), 0);
+            BlendSink sink({ a.data(), size, size });
+            CoverageBlendPlot plot = { b.data(), size, size };
+            double r = seconds([&] { runtimeAll(sink); });
+            double t = seconds([&] { templatedAll(plot, nothing); });
+            bool same = checksum(a) == checksum(b);
+            allSame &= same;
+            report(prefix + "blend", r, t, count, same);
+        }
+        // Span emit
+        {
+            uint64_t spansA = 0, pixelsA = 0, spansB = 0, pixelsB = 0;
+            SpanSink sink({ &spansA, &pixelsA });
+            SpanPlot<SpanCounter> plot({ &spansB, &pixelsB });
+            double r = seconds([&] { runtimeAll(sink); });
+            double t = seconds([&] { templatedAll(plot, [&] { plot.flush(); }); });
+            bool same = spansA == spansB && pixelsA == pixelsB;
+            allSame &= same;
+            report(prefix + "spans", r, t, count, same);
+        }
+        // Counting
+        {
+            CountSink sink;
+            CountPlot plot;
+            double r = seconds([&] { runtimeAll(sink); });
+            double t = seconds([&] { templatedAll(plot, nothing); });
+            bool same = sink.p.plots == plot.plots && sink.p.coverage == plot.coverage;
+            allSame &= same;
+            report(prefix + "count", r, t, count, same);
+        }
+    }
+    // Float against fixed-point Wu, on the endpoints rounded to pixels
+    vector<Line> rounded(lines);
+    for (Line& l : rounded) l = { roundf(l.x0), roundf(l.y0), roundf(l.x1), roundf(l.y1) };
+
+    int worst = 0;
+    vector<uint8_t> single((size_t)size * size, 0);
+    for (size_t i = 0; i < min<size_t>(count, 2000); ++i) {
+        // One line at a time, so overlaps cannot hide differences
+        const Line& l = rounded[i];
+        CanvasPlot plot = { single.data(), size, size };
+        drawWuLine(l.x0, l.y0, l.x1, l.y1, plot);
+        vector<pair<size_t, int>> expected;
+        drawWuLine(l.x0, l.y0, l.x1, l.y1, [&](int x, int y, float) {
+            size_t at = (size_t)y * size + x;
+            if ((unsigned)x < (unsigned)size && (unsigned)y < (unsigned)size) expected.push_back({ at, single[at] });
+        });
+        for (auto& e : expected) single[e.first] = 0;
+        drawWuLineFixed(int(l.x0), int(l.y0), int(l.x1), int(l.y1), plot);
+        for (auto& e : expected) worst = max(worst, abs(single[e.first] - e.second));
+        for (auto& e : expected) single[e.first] = 0;
+    }
+    bool withinOne = worst <= 1;
+    allSame &= withinOne;
+
+    cout << "\n" << left << setw(26) << "Wu, integer endpoints" << right << setw(10) << "float" << setw(12) << "fixed"
+         << setw(10) << "speedup" << "\n";
+    {
+        fill(a.begin(), a.end(), 0); fill(b.begin(), b.end(), 0);
+        CanvasPlot fa = { a.data(), size, size }, fb = { b.data(), size, size };
+        double r = seconds([&] { for (const Line& l : rounded) drawWuLine(l.x0, l.y0, l.x1, l.y1, fa); });
+        double t = seconds([&] { for (const Line& l : rounded) drawWuLineFixed(int(l.x0), int(l.y0), int(l.x1), int(l.y1), fb); });
+        report("Wu / canvas", r, t, count, withinOne);
+    }
+    {
+        CountPlot ca, cb;
+        double r = seconds([&] { for (const Line& l : rounded) drawWuLine(l.x0, l.y0, l.x1, l.y1, ca); });
+        double t = seconds([&] { for (const Line& l : rounded) drawWuLineFixed(int(l.x0), int(l.y0), int(l.x1), int(l.y1), cb); });
+        // The coverage sums are the result: compared (each plot may be one
+        // step of 255 off) and printed, so neither loop can be optimized
+        // down to counting
+        double drift = fabs(ca.coverage - cb.coverage), bound = ca.plots / 255.0 * (1 + 1e-6);
+        bool agree = ca.plots == cb.plots && drift <= bound;
+        allSame &= agree;
+        report("Wu / count", r, t, count, agree);
+        cout << "coverage sums: float " << ca.coverage << ", fixed " << cb.coverage << ", difference "
+             << drift << " (bound " << bound << ")\n";
+    }
+    cout << "largest coverage difference: " << worst << " / 255\n";
+    return allSame ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// SceneStream.cpp
+// Streams a text scene (../common/scene_stream.h) onto a character canvas:
+// a worker thread parses the file in batches while this thread rasterizes
+// the previous batch with the line, circle and ellipse drawers of
+// ../common/char_canvas.h.
+//
+//   g++ -O2 -std=c++17 -pthread SceneStream.cpp -o SceneStream
+//   ./SceneStream ../scenes/demo.txt 80 40 scene.txt
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include "../common/scene_stream.h"
+#include "../common/char_canvas.h"
+using namespace std;
+
+// World window -> canvas cells
+struct Viewport {
+    float view[4];   // l r b t
+    int w, h;
+    int x(float wx) const { return int(round((wx - view[0]) / (view[1] - view[0]) * (w - 1))); }
+    int y(float wy) const { return int(round((wy - view[2]) / (view[3] - view[2]) * (h - 1))); }
+    int rx(float r) const { return int(round(r / (view[1] - view[0]) * (w - 1))); }
+    int ry(float r) const { return int(round(r / (view[3] - view[2]) * (h - 1))); }
+};
+
+// Rasterize one parsed batch
+void drawBatch(const SceneBuilder &batch, const Viewport &vp, Canvas &canvas,
+               LineDrawer &lines, DDALineDrawer &dda) {
+    for (size_t i = 0; i + 1 < batch.lineVertices.size(); i += 2) {
+        auto &a = batch.lineVertices[i], &b = batch.lineVertices[i + 1];
+        lines.drawLine(vp.x(a.x), vp.y(a.y), vp.x(b.x), vp.y(b.y), '*');
+    }
+    for (size_t p = 0; p < batch.polygonFirst.size(); ++p) {
+        int first = batch.polygonFirst[p], n = batch.polygonCount[p];
+        for (int i = 0; i < n; ++i) {
+            auto &A = batch.polygonVertices[first + i], &B = batch.polygonVertices[first + (i + 1) % n];
+            dda.draw(vp.x(A.x), vp.y(A.y), vp.x(B.x), vp.y(B.y), '#');
+        }
+    }
+    for (auto &c : batch.circles) {
+        int rx = vp.rx(c.radius), ry = vp.ry(c.radius);
+        if (rx == ry) drawCircle(canvas, vp.x(c.cx), vp.y(c.cy), rx, 'o');
+        else drawEllipse(canvas, vp.x(c.cx), vp.y(c.cy), rx, ry, 'o');   // non-square cells
+    }
+    for (auto &e : batch.ellipses)
+        drawEllipse(canvas, vp.x(e.cx), vp.y(e.cy), vp.rx(e.rx), vp.ry(e.ry), '@');
+    for (auto &l : batch.labels) {
+        int x = vp.x(l.x), y = vp.y(l.y);
+        for (uint32_t i = 0; i < l.textLength; ++i)
+            canvas.plot(x + (int)i, y, batch.labelText[l.textOffset + i]);
+    }
+}
+
+int main(int argc, char **argv) {
+    try {
+        if (argc < 2 || argc > 5)
+            throw invalid_argument(string("usage: ") + argv[0] + " <scene.txt> [width height] [out.txt]");
+        int W = argc >= 4 ? stoi(argv[2]) : 60;
+        int H = argc >= 4 ? stoi(argv[3]) : 30;
+        if (W <= 1 || H <= 1) throw invalid_argument("Invalid canvas size.");
+        string outFile = argc == 5 ? argv[4] : argc == 3 ? argv[2] : "";
+
+        Canvas canvas(W, H);
+        LineDrawer lines(canvas);
+        DDALineDrawer dda(canvas);
+
+        // The window is the scene's 'view' line; a scene without one is
+        // fitted to its first batch (later primitives may fall outside).
+        Viewport vp = { { 0, 0, 0, 0 }, W, H };
+        bool haveView = false;
+        auto consume = [&](const SceneBuilder &batch) {
+            if (batch.hasView) {
+                copy(batch.view, batch.view + 4, vp.view);
+                haveView = true;
+            } else if (!haveView) {
+                SceneBuilder fit = batch;
+                fit.fitView();
+                copy(fit.view, fit.view + 4, vp.view);
+                haveView = true;
+            }
+            drawBatch(batch, vp, canvas, lines, dda);
+        };
+
+        string err;
+        SceneStreamStats stats;
+        if (!streamSceneFile(argv[1], consume, err, SCENE_STREAM_BATCH, &stats))
+            throw runtime_error(err);
+
+        if (W <= 120) canvas.display();
+        cout << "\n" << stats.primitives << " primitives (" << stats.bytes << " bytes) in "
+             << stats.batches << " batches: parse " << stats.parseMs << " ms, raster "
+             << stats.consumeMs << " ms, wall " << stats.wallMs << " ms\n";
+        if (!outFile.empty()) {
+            canvas.save(outFile);
+            cout << "Saved canvas to " << outFile << "\n";
+        }
+    } catch (const exception &e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+// bit_canvas.h
+// One bit per pixel for binary masks: 8x less memory than a char per cell,
+// and a horizontal run is a few 64-bit word writes instead of a byte loop.
+// Queries (pixel count, bounding box) run a word at a time with popcount
+// and bit scans. Pixels become chars or gray bytes only when unpacked for
+// output, one row at a time.
+//
+//   BitCanvas mask(w, h);
+//   mask.fillSpan(y, x0, x1);                // [x0, x1) of row y
+//   mask.set(x, y);
+//   uint64_t n = mask.count();
+//   BitRect box;
+//   if (mask.boundingBox(box)) ...
+//   mask.unpackRow(y, line.data(), '#', '.'); // or (uint8_t)255, (uint8_t)0
+//
+// Row 0 is the bottom row, as on the character canvases. Bit i of word k
+// of a row is pixel 64*k + i; bits past the width are always zero.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Half-open pixel rectangle [x0, x1) x [y0, y1)
+struct BitRect {
+    int x0, y0, x1, y1;
+};
+
+namespace bit_canvas_detail {
+
+inline int popcount(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(v);
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((v * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Index of the lowest / highest set bit; v != 0
+inline int lowestBit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(v);
+#else
+    int i = 0;
+    while (!(v & 1)) { v >>= 1; ++i; }
+    return i;
+#endif
+}
+inline int highestBit(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    int i = 63;
+    while (!(v >> 63)) { v <<= 1; --i; }
+    return i;
+#endif
+}
+
+// Bits [from, 64) of a word; from in 0..63
+inline uint64_t maskFrom(int from) { return ~uint64_t(0) << from; }
+// Bits [0, to) of a word; to in 1..64
+inline uint64_t maskTo(int to) { return ~uint64_t(0) >> (64 - to); }
+
+} // namespace bit_canvas_detail
+
+class BitCanvas {
+public:
+    BitCanvas(int w = 0, int h = 0) { resize(w, h); }
+
+    void resize(int w, int h) {
+        width_ = w; height_ = h;
+        stride = (w + 63) / 64;
+        bits.assign((size_t)stride * h, 0);
+    }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    size_t bytes() const { return bits.size() * sizeof(uint64_t); }
+
+    void clear() { std::fill(bits.begin(), bits.end(), 0); }
+
+    void set(int x, int y) {
+        if (x >= 0 && x < width_ && y >= 0 && y < height_)
+            bits[(size_t)y * stride + (x >> 6)] |= uint64_t(1) << (x & 63);
+    }
+    bool test(int x, int y) const {
+        if (x < 0 || x >= width_ || y < 0 || y >= height_) return false;
+        return (bits[(size_t)y * stride + (x >> 6)] >> (x & 63)) & 1;
+    }
+
+    // Set [x0, x1) of row y, clipped: partial words at the ends, whole
+    // words in between
+    void fillSpan(int y, int x0, int x1) {
+        using namespace bit_canvas_detail;
+        if (y < 0 || y >= height_) return;
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, width_);
+        if (x0 >= x1) return;
+        uint64_t* row = bits.data() + (size_t)y * stride;
+        int w0 = x0 >> 6, w1 = (x1 - 1) >> 6;
+        if (w0 == w1) {
+            row[w0] |= maskFrom(x0 & 63) & maskTo(((x1 - 1) & 63) + 1);
+            return;
+        }
+        row[w0] |= maskFrom(x0 & 63);
+        std::fill(row + w0 + 1, row + w1, ~uint64_t(0));
+        row[w1] |= maskTo(((x1 - 1) & 63) + 1);
+    }
+
+    // Pixels set, over everything or one row
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (uint64_t w : bits) n += bit_canvas_detail::popcount(w);
+        return n;
+    }
+    int countRow(int y) const {
+        const uint64_t* row = bits.data() + (size_t)y * stride;
+        int n = 0;
+        for (int k = 0; k < stride; ++k) n += bit_canvas_detail::popcount(row[k]);
+        return n;
+    }
+
+    // Smallest rectangle holding every set pixel; false if there is none.
+    // Rows are found by testing whole words, columns from the OR of the
+    // rows in between, scanned for its lowest and highest bits.
+    bool boundingBox(BitRect& box) const {
+        using namespace bit_canvas_detail;
+        int y0 = 0, y1 = height_;
+        while (y0 < y1 && rowEmpty(y0)) ++y0;
+        if (y0 == y1) return false;
+        while (rowEmpty(y1 - 1)) --y1;
+
+        columns.assign(stride, 0);
+        for (int y = y0; y < y1; ++y) {
+            const uint64_t* row = bits.data() + (size_t)y * stride;
+            for (int k = 0; k < stride; ++k) columns[k] |= row[k];
+        }
+        int k0 = 0, k1 = stride - 1;
+        while (!columns[k0]) ++k0;
+        while (!columns[k1]) --k1;
+        box = { 64 * k0 + lowestBit(columns[k0]), y0, 64 * k1 + highestBit(columns[k1]) + 1, y1 };
+        return true;
+    }
+
+    // Row y as 'on' / 'off' values (chars, gray bytes, ...), width() of them
+    template <class T>
+    void unpackRow(int y, T* out, T on, T off) const {
+        const uint64_t* row = bits.data() + (size_t)y * stride;
+        for (int k = 0; k < stride; ++k) {
+            uint64_t w = row[k];
+            int n = std::min(64, width_ - 64 * k);
+            T* o = out + 64 * k;
+            if (w == 0) { std::fill(o, o + n, off); continue; }
+            for (int i = 0; i < n; ++i) o[i] = (w >> i) & 1 ? on : off;
+        }
+    }
+
+    // Raw words of row y, wordsPerRow() of them
+    const uint64_t* row(int y) const { return bits.data() + (size_t)y * stride; }
+    int wordsPerRow() const { return stride; }
+
+private:
+    bool rowEmpty(int y) const {
+        const uint64_t* row = bits.data() + (size_t)y * stride;
+        for (int k = 0; k < stride; ++k)
+            if (row[k]) return false;
+        return true;
+    }
+
+    int width_ = 0, height_ = 0, stride = 0;
+    std::vector<uint64_t> bits;
+    mutable std::vector<uint64_t> columns;   // boundingBox() scratch
+};
@@ -0,0 +1,304 @@
+// char_canvas.h
+// The character canvas of the OpeenGL_LineDrawingAlgorithms tools and the
+// drawers that plot on it: Bresenham and DDA lines (written as whole runs
+// per row), the Bresenham circle and the midpoint ellipse. A canvas keeps
+// one char per cell, one bit per cell (bit_canvas.h), runs per row
+// (run_canvas.h) or sparse tiles (sparse_canvas.h); chars appear only when
+// a row is displayed, saved or exported.
+//
+//   Canvas canvas(80, 40, '.', CanvasMode::Runs);
+//   LineDrawer(canvas).drawLine(0, 0, 79, 39, '*');
+//   DDALineDrawer(canvas).draw(0, 39, 79, 0, '#');
+//   drawCircle(canvas, 40, 20, 10, 'o');
+//   canvas.display();
+//
+// Row 0 is the bottom row.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bit_canvas.h"
+#include "run_canvas.h"
+#include "sparse_canvas.h"
+#include "image_stream.h"
+
+// Widest canvas display() prints and the tools save as text
+const int CANVAS_DISPLAY_MAX_WIDTH = 200;
+// Rows per band handed to the image writer, at most this many bytes
+const size_t CANVAS_EXPORT_BAND_BYTES = 4 << 20;
+
+// How a canvas stores its cells
+enum class CanvasMode { Chars, Bits, Runs, Tiles };
+
+// === Canvas ===
+// One char per cell, one bit per cell (every set cell shows the last
+// symbol drawn), runs per row, or sparse tiles
+class Canvas {
+    int width, height;
+    std::vector<std::string> grid;
+    char bg;
+    CanvasMode mode;
+    BitCanvas mask;
+    RunCanvas runs;
+    SparseCanvas<char> tiles;
+    char ink = '#';
+
+public:
+    Canvas(int w, int h, char bgSym = '.', CanvasMode m = CanvasMode::Chars)
+      : width(w), height(h), bg(bgSym), mode(m) {
+        if (mode == CanvasMode::Bits) mask.resize(w, h);
+        else if (mode == CanvasMode::Runs) runs.resize(w, h, bgSym);
+        else if (mode == CanvasMode::Tiles) tiles.resize(w, h, bgSym);
+        else grid.assign(h, std::string(w, bgSym));
+    }
+
+    // A run-length encoded canvas from a file written by save()
+    static Canvas loadRLE(const std::string &filename) {
+        std::ifstream ifs(filename);
+        if (!ifs) throw std::runtime_error("Cannot open file: " + filename);
+        RunCanvas loaded;
+        loaded.load(ifs);
+        Canvas c(loaded.width(), loaded.height(), loaded.background(), CanvasMode::Runs);
+        c.runs = std::move(loaded);
+        return c;
+    }
+
+    void plot(int x, int y, char sym = '#') {
+        if (mode != CanvasMode::Chars) { fillSpan(y, x, x + 1, sym); return; }
+        if (x>=0 && x<width && y>=0 && y<height)
+            grid[height - 1 - y][x] = sym;
+    }
+
+    // Horizontal run [x0, x1) of row y
+    void fillSpan(int y, int x0, int x1, char sym = '#') {
+        if (mode == CanvasMode::Bits) { mask.fillSpan(y, x0, x1); ink = sym; return; }
+        if (mode == CanvasMode::Runs) { runs.fillSpan(y, x0, x1, sym); return; }
+        if (mode == CanvasMode::Tiles) { tiles.fillSpan(y, x0, x1, sym); return; }
+        if (y < 0 || y >= height) return;
+        x0 = std::max(x0, 0); x1 = std::min(x1, width);
+        if (x0 < x1) std::fill(grid[height - 1 - y].begin() + x0, grid[height - 1 - y].begin() + x1, sym);
+    }
+
+    void clear() {
+        if (mode == CanvasMode::Bits) { mask.clear(); return; }
+        if (mode == CanvasMode::Runs) { runs.clear(); return; }
+        if (mode == CanvasMode::Tiles) { tiles.clear(); return; }
+        for (auto &row : grid) row.assign(width, bg);
+    }
+
+    // Row y (0 = bottom) as chars
+    void rowChars(int y, std::string &out) const {
+        out.resize(width);
+        if (mode == CanvasMode::Bits) mask.unpackRow(y, &out[0], ink, bg);
+        else if (mode == CanvasMode::Runs) runs.decodeRow(y, &out[0]);
+        else if (mode == CanvasMode::Tiles) tiles.readRow(y, 0, width, &out[0]);
+        else out = grid[height - 1 - y];
+    }
+
+    bool printable() const { return width <= CANVAS_DISPLAY_MAX_WIDTH; }
+
+    // Every cell followed by a space, top row first; a canvas too wide to
+    // print is summarized
+    void display() const {
+        if (!printable()) {
+            std::cout << "(" << width << "x" << height << " canvas, too wide to print)\n";
+            return;
+        }
+        std::string row;
+        for (int y = height - 1; y >= 0; --y) {
+            rowChars(y, row);
+            for (char c : row) std::cout << c << ' ';
+            std::cout << '\n';
+        }
+    }
+
+    // Run-length encoded in Runs mode, every cell otherwise
+    void save(const std::string &filename) const {
+        if (mode != CanvasMode::Runs) { saveText(filename); return; }
+        std::ofstream ofs(filename);
+        if (!ofs) throw std::runtime_error("Cannot open file: " + filename);
+        runs.save(ofs);
+    }
+
+    // Dense text: every cell followed by a space, a row per write
+    void saveText(const std::string &filename) const {
+        AlignedFileWriter out(filename);
+        std::string row, line(2 * width + 1, ' ');
+        line.back() = '\n';
+        for (int y = height - 1; y >= 0; --y) {
+            rowChars(y, row);
+            for (int x = 0; x < width; ++x) line[2 * x] = row[x];
+            out.write(line.data(), line.size());
+        }
+        out.close();
+    }
+
+    // Image (format from the extension), streamed from the canvas in bands
+    // of rows, top row first: background white, '*' red, '#' blue, other
+    // symbols black (gray for PGM and PNG: background white, cells black)
+    void exportImage(const std::string &filename, TileScheduler *sched) const {
+        int channels = imageFormatFor(filename) == ImageFormat::PPM ? 3 : 1;
+        size_t rowBytes = (size_t)width * channels;
+        int bandRows = (int)std::max<size_t>(1, CANVAS_EXPORT_BAND_BYTES / rowBytes);
+        ImageStreamWriter out(filename, width, height, channels, sched);
+        std::vector<uint8_t> band((size_t)std::min(bandRows, height) * rowBytes);
+        std::string row;
+        for (int top = height - 1; top >= 0; top -= bandRows) {
+            int n = std::min(bandRows, top + 1);
+            for (int i = 0; i < n; ++i) {
+                rowChars(top - i, row);
+                uint8_t *o = band.data() + (size_t)i * rowBytes;
+                for (int x = 0; x < width; ++x) {
+                    char c = row[x];
+                    if (channels == 1) { o[x] = c == bg ? 255 : 0; continue; }
+                    uint8_t *px = o + 3 * x;
+                    if (c == bg)       { px[0] = 255; px[1] = 255; px[2] = 255; }
+                    else if (c == '*') { px[0] = 200; px[1] = 40;  px[2] = 40;  }
+                    else if (c == '#') { px[0] = 40;  px[1] = 40;  px[2] = 200; }
+                    else               { px[0] = 0;   px[1] = 0;   px[2] = 0;   }
+                }
+            }
+            out.writeRows(band.data(), n, rowBytes);
+        }
+        out.finish();
+    }
+
+    // Cells drawn on, and their bounding box (false if none)
+    long countSet() const {
+        if (mode == CanvasMode::Bits) return (long)mask.count();
+        if (mode == CanvasMode::Runs) return (long)runs.count();
+        if (mode == CanvasMode::Tiles) return (long)tiles.count();
+        long n = 0;
+        for (auto &row : grid) n += width - std::count(row.begin(), row.end(), bg);
+        return n;
+    }
+    bool boundingBox(BitRect &box) const {
+        if (mode == CanvasMode::Bits) return mask.boundingBox(box);
+        if (mode == CanvasMode::Runs) return runs.boundingBox(box);
+        if (mode == CanvasMode::Tiles) return tiles.boundingBox(box);
+        box = { width, height, 0, 0 };
+        for (int r = 0; r < height; ++r)
+            for (int x = 0; x < width; ++x)
+                if (grid[r][x] != bg) {
+                    int y = height - 1 - r;
+                    box = { std::min(box.x0, x), std::min(box.y0, y), std::max(box.x1, x + 1), std::max(box.y1, y + 1) };
+                }
+        return box.x0 < box.x1;
+    }
+
+    // Tiles touched and bytes held, in Tiles mode
+    size_t tileCount() const { return tiles.tileCount(); }
+    size_t tileBytes() const { return tiles.bytes(); }
+};
+
+// === Drawers ===
+// Bresenham's line
+class LineDrawer {
+    Canvas &canvas;
+
+public:
+    LineDrawer(Canvas &c) : canvas(c) {}
+
+    void drawLine(int x1, int y1, int x2, int y2, char symbol = '*') {
+        int dx = std::abs(x2 - x1);
+        int dy = std::abs(y2 - y1);
+        int sx = (x1 < x2) ? 1 : -1;
+        int sy = (y1 < y2) ? 1 : -1;
+        int err = dx - dy;
+
+        // Consecutive cells on one row go to the canvas as a single run
+        int runStart = x1;
+        while (true) {
+            if (x1 == x2 && y1 == y2) break;
+
+            int e2 = 2 * err;
+            int prevX = x1, prevY = y1;
+            if (e2 > -dy) { err -= dy; x1 += sx; }
+            if (e2 < dx)  { err += dx; y1 += sy; }
+            if (y1 != prevY) {
+                canvas.fillSpan(prevY, std::min(runStart, prevX), std::max(runStart, prevX) + 1, symbol);
+                runStart = x1;
+            }
+        }
+        canvas.fillSpan(y1, std::min(runStart, x1), std::max(runStart, x1) + 1, symbol);
+    }
+};
+
+// DDA line
+class DDALineDrawer {
+    Canvas &canvas;
+
+public:
+    DDALineDrawer(Canvas &c) : canvas(c) {}
+
+    void draw(int x0, int y0, int x1, int y1, char sym='#') {
+        int dx = x1 - x0, dy = y1 - y0;
+        int steps = std::max(std::abs(dx), std::abs(dy));
+        if (steps == 0) { canvas.plot(x0,y0,sym); return; }
+
+        float xInc = float(dx)/steps;
+        float yInc = float(dy)/steps;
+        float x = x0, y = y0;
+
+        // Consecutive cells on one row go to the canvas as a single run
+        int runY = int(std::round(y)), runX0 = int(std::round(x)), runX1 = runX0;
+        for (int i = 1; i <= steps; ++i) {
+            x += xInc;  y += yInc;
+            int px = int(std::round(x)), py = int(std::round(y));
+            if (py == runY && (px == runX1 + 1 || px == runX0 - 1)) {
+                runX0 = std::min(runX0, px); runX1 = std::max(runX1, px);
+                continue;
+            }
+            canvas.fillSpan(runY, runX0, runX1 + 1, sym);
+            runY = py; runX0 = runX1 = px;
+        }
+        canvas.fillSpan(runY, runX0, runX1 + 1, sym);
+    }
+};
+
+// Bresenham circle, eight-way symmetry
+inline void drawCircle(Canvas &canvas, int cx, int cy, int r, char sym) {
+    int x = 0, y = r;
+    int d = 3 - 2 * r;
+    while (x <= y) {
+        int pts[8][2] = { {x,y}, {-x,y}, {x,-y}, {-x,-y}, {y,x}, {-y,x}, {y,-x}, {-y,-x} };
+        for (auto &p : pts) canvas.plot(cx + p[0], cy + p[1], sym);
+        if (d < 0) d += 4 * x + 6;
+        else { d += 4 * (x - y) + 10; y--; }
+        x++;
+    }
+}
+
+// Midpoint ellipse: region 1 steps in x while the slope is shallow,
+// region 2 steps in y
+inline void drawEllipse(Canvas &canvas, int cx, int cy, int rx, int ry, char sym) {
+    auto plot4 = [&](long x, long y) {
+        canvas.plot(cx + x, cy + y, sym); canvas.plot(cx - x, cy + y, sym);
+        canvas.plot(cx + x, cy - y, sym); canvas.plot(cx - x, cy - y, sym);
+    };
+    long rx2 = (long)rx * rx, ry2 = (long)ry * ry;
+    long x = 0, y = ry;
+    long px = 0, py = 2 * rx2 * y;
+
+    double p = ry2 - rx2 * ry + 0.25 * rx2;
+    while (px < py) {
+        plot4(x, y);
+        x++; px += 2 * ry2;
+        if (p < 0) p += ry2 + px;
+        else { y--; py -= 2 * rx2; p += ry2 + px - py; }
+    }
+    p = ry2 * (x + 0.5) * (x + 0.5) + rx2 * (y - 1.0) * (y - 1.0) - (double)rx2 * ry2;
+    while (y >= 0) {
+        plot4(x, y);
+        y--; py -= 2 * rx2;
+        if (p > 0) p += rx2 - py;
+        else { x++; px += 2 * ry2; p += rx2 - py + px; }
+    }
+}
@@ -0,0 +1,348 @@
+// conic_raster.h
+// Integer midpoint rasterization of general conics
+//   A*x^2 + B*x*y + C*y^2 + D*x + E*y + F = 0
+// (ellipses at any rotation, parabolas, hyperbola branches), producing
+// horizontal pixel spans. The curve is cut where its tangent is
+// horizontal or vertical, so each piece is monotone in x and y, and each
+// piece is traced pixel by pixel to its end. At each point the gradient
+// gives the octant of the tangent: one axis always steps, the other
+// steps when the conic's value at the midpoint between the two
+// candidates says the curve passes beyond it, as in the midpoint circle
+// and ellipse algorithms of the CAT1 demos. The conic's value and
+// gradient are updated with constant integer increments (the second
+// differences 2A, B, 2C), so the inner loop has no multiplies by
+// coordinates and no floating point.
+//
+//   IntConic c = RealConic::rotatedEllipse(0, 0, 8, 3, 0.5).toPixels(view, w, h).quantize(w, h);
+//   rasterConic(c, start, start, +1, { 0, 0, w, h },
+//               [&](int y, int x0, int x1) { fill(y, x0, x1); });
+//
+// Coordinates are pixel centers at integer (x, y), row 0 at the bottom.
+// Where the curve turns tighter than a pixel (the tips of a thin
+// ellipse) the pixels stay within a pixel of it rather than following
+// the midpoint rule exactly. OpeenGL_LineDrawingAlgorithms/ConicCheck.cpp
+// checks circles against the midpoint circle algorithm and thin ellipses
+// for gaps.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include "tile_scheduler.h"
+
+const int64_t CONIC_MAX_STEPS = int64_t(1) << 24;   // safety net for open curves
+const double CONIC_TERM_LIMIT = 0x1p56;            // |largest term| after quantization
+
+// Integer coefficients in pixel-center coordinates; the trace stays
+// within |x|, |y| <= extent, where the 64-bit terms cannot overflow
+struct IntConic {
+    int64_t A, B, C, D, E, F;
+    int extent;
+};
+
+struct ConicPixel {
+    int x, y;
+};
+
+// === Real-valued conics ===
+struct RealConic {
+    double A, B, C, D, E, F;
+
+    // Ellipse centered at (cx, cy) with semi-axes a, b, the a axis rotated
+    // by 'angle' radians; negative inside
+    static RealConic rotatedEllipse(double cx, double cy, double a, double b, double angle) {
+        double c = std::cos(angle), s = std::sin(angle);
+        double ia = 1.0 / (a * a), ib = 1.0 / (b * b);
+        RealConic q;
+        q.A = c * c * ia + s * s * ib;
+        q.B = 2 * c * s * (ia - ib);
+        q.C = s * s * ia + c * c * ib;
+        q.D = -2 * q.A * cx - q.B * cy;
+        q.E = -q.B * cx - 2 * q.C * cy;
+        q.F = q.A * cx * cx + q.B * cx * cy + q.C * cy * cy - 1;
+        return q;
+    }
+
+    // x = a*y^2 + b*y + c; negative on the +x side
+    static RealConic parabolaX(double a, double b, double c) { return { 0, 0, a, -1, b, c }; }
+
+    // x^2/a^2 - y^2/b^2 = 1 moved to (cx, cy); negative between the branches
+    static RealConic hyperbola(double cx, double cy, double a, double b) {
+        double ia = 1.0 / (a * a), ib = -1.0 / (b * b);
+        return { ia, 0, ib, -2 * ia * cx, -2 * ib * cy, ia * cx * cx + ib * cy * cy - 1 };
+    }
+
+    // World coordinates of an orthographic view (left, right, bottom,
+    // top) to pixel centers of a width x height window
+    RealConic toPixels(const float view[4], int width, int height) const {
+        // world x = p*X + q, y = r*Y + s
+        double p = (view[1] - view[0]) / width, q = view[0] + 0.5 * p;
+        double r = (view[3] - view[2]) / height, s = view[2] + 0.5 * r;
+        RealConic o;
+        o.A = A * p * p;
+        o.B = B * p * r;
+        o.C = C * r * r;
+        o.D = 2 * A * p * q + B * p * s + D * p;
+        o.E = B * q * r + 2 * C * r * s + E * r;
+        o.F = A * q * q + B * q * s + C * s * s + D * q + E * s + F;
+        return o;
+    }
+
+    // Round to integers, scaled so that over a window of this size (with
+    // a window's margin on every side) no term exceeds CONIC_TERM_LIMIT
+    IntConic quantize(int width, int height) const {
+        int extent = 2 * std::max(width, height);
+        double R = 2.0 * extent;                              // half-pixel units
+        double largest = std::max({ std::fabs(A) * R * R, std::fabs(B) * R * R, std::fabs(C) * R * R,
+                                    std::fabs(D) * R, std::fabs(E) * R, std::fabs(F) });
+        double k = largest > 0 ? CONIC_TERM_LIMIT / largest : 1.0;
+        auto q = [&](double v) { return (int64_t)std::llround(v * k); };
+        return { q(A), q(B), q(C), q(D), q(E), q(F), extent };
+    }
+};
+
+// === Tracer ===
+namespace conic_detail {
+
+// Collects pixels into horizontal spans [x0, x1) and emits them clipped
+template <class Sink>
+struct SpanBuilder {
+    Sink& sink;
+    TileRect clip;
+    int y = 0, x0 = 0, x1 = 0;
+    bool open = false;
+
+    void add(int px, int py) {
+        if (open && py == y && (px == x1 || px == x0 - 1)) {
+            if (px == x1) ++x1; else --x0;
+            return;
+        }
+        flush();
+        y = py; x0 = px; x1 = px + 1;
+        open = true;
+    }
+    void flush() {
+        if (!open) return;
+        open = false;
+        if (y < clip.y0 || y >= clip.y1) return;
+        int a = std::max(x0, clip.x0), b = std::min(x1, clip.x1);
+        if (a < b) sink(y, a, b);
+    }
+};
+
+// Which way the minor axis steps, from the conic's values at the two
+// midpoints beside the new pixel (lo: minor - 1/2, hi: minor + 1/2): none
+// when the curve passes between them, else toward the one nearer zero.
+// A midpoint exactly on the curve counts as outside, as in the midpoint
+// circle algorithm.
+inline int minorStep(int64_t lo, int64_t hi) {
+    if ((lo < 0) != (hi < 0)) return 0;
+    int64_t alo = lo < 0 ? -lo : lo, ahi = hi < 0 ? -hi : hi;
+    return alo < ahi ? -1 : ahi < alo ? 1 : 0;
+}
+
+// A point where the tangent is horizontal or vertical: its nearest pixel
+// and the direction of travel there (0, pi/2, pi or 3pi/2)
+struct TurnPoint {
+    double key;   // travel angle, then position along the trace
+    int x, y;
+};
+
+// Real roots of a*t^2 + b*t + c, 0 to 2 of them
+inline int solveQuadratic(double a, double b, double c, double t[2]) {
+    if (a == 0) {
+        if (b == 0) return 0;
+        t[0] = -c / b;
+        return 1;
+    }
+    double disc = b * b - 4 * a * c;
+    if (disc < 0) return 0;
+    double q = -0.5 * (b + std::copysign(std::sqrt(disc), b));
+    if (q == 0) { t[0] = 0; return 1; }
+    t[0] = q / a;
+    t[1] = c / q;
+    return 2;
+}
+
+// The points of the conic where dF/dy = 0 (vertical tangent) or dF/dx = 0
+// (horizontal tangent), at most four, inside the extent. Between two of
+// them met in turn the curve is monotone in both x and y.
+inline int axisTurns(const IntConic& c, int orientation, TurnPoint out[4]) {
+    const double A = (double)c.A, B = (double)c.B, C = (double)c.C, D = (double)c.D, E = (double)c.E, F = (double)c.F;
+    const double PI = 3.14159265358979323846;
+    int n = 0;
+    for (int axis = 0; axis < 2; ++axis) {
+        // The line n.p + k = 0, as p0 + t*d
+        double nx = axis ? 2 * A : B, ny = axis ? B : 2 * C, k = axis ? D : E;
+        double nn = nx * nx + ny * ny;
+        if (nn == 0) continue;
+        double px = -k * nx / nn, py = -k * ny / nn, dx = -ny, dy = nx;
+        double a = A * dx * dx + B * dx * dy + C * dy * dy;
+        double b = (2 * A * px + B * py + D) * dx + (B * px + 2 * C * py + E) * dy;
+        double cc = A * px * px + B * px * py + C * py * py + D * px + E * py + F;
+        double t[2];
+        int roots = solveQuadratic(a, b, cc, t);
+        for (int i = 0; i < roots; ++i) {
+            double x = px + t[i] * dx, y = py + t[i] * dy;
+            if (!(std::fabs(x) <= c.extent && std::fabs(y) <= c.extent)) continue;
+            // Travel is orientation * (-dF/dy, dF/dx): along y on the
+            // first line, along x on the second
+            double g = axis ? -(B * x + 2 * C * y + E) : 2 * A * x + B * y + D;
+            if (g == 0) continue;                          // singular point
+            double angle = axis ? (g * orientation > 0 ? 0 : PI) : (g * orientation > 0 ? 0.5 * PI : 1.5 * PI);
+            out[n++] = { angle, (int)std::lround(x), (int)std::lround(y) };
+        }
+    }
+    return n;
+}
+
+} // namespace conic_detail
+
+// Trace from pixel 'from' to pixel 'to' (equal for a closed curve) along
+// the conic and emit spans inside 'clip' as sink(y, x0, x1), x1
+// exclusive. orientation +1 moves counter-clockwise around the region
+// where the conic is negative, -1 clockwise. 'from' and 'to' should be
+// the pixels nearest the curve.
+//
+// The curve is first cut where its tangent is horizontal or vertical
+// (found in floating point, once); the travel direction turns steadily
+// along a conic's branch, so sorting the cuts by the direction there
+// puts them in trace order. Each piece is monotone in x and y, and is
+// walked pixel by pixel to the pixel nearest its end: one axis steps
+// along the tangent, the other when the conic's value at the midpoint
+// between the two candidates says the curve passes beyond it, and a
+// pixel past an octant boundary must also pass that octant's rule, so
+// circles with integer radius give exactly the pixels of the integer
+// midpoint circle algorithm (OpeenGL_LineDrawingAlgorithms/ConicCheck.cpp
+// checks this). Steps never move away from the piece's end, so every
+// step makes progress and the trace always reaches 'to': where the
+// midpoint rule would turn back or leave the curve (a tip sharper than a
+// pixel), the step goes to the allowed neighbour nearest the curve
+// instead. Returns the number of pixels traced, or -1 if the trace gave
+// up: it left the extent or ran past maxSteps. The spans emitted up to
+// that point are still delivered.
+template <class Sink>
+int64_t rasterConic(const IntConic& c, ConicPixel from, ConicPixel to, int orientation, const TileRect& clip,
+                    Sink&& sink, int64_t maxSteps = CONIC_MAX_STEPS) {
+    using conic_detail::minorStep;
+    using conic_detail::TurnPoint;
+    // G(X, Y) = 4 * F(X/2, Y/2) over half-pixel units X = 2x, Y = 2y, so
+    // midpoints are integers too. Lx, Ly are the forward-difference terms:
+    // G(X + 2s, Y) = G + s*Lx + 4A and G(X + s, Y) = G + s*Lx/2 + A, same in Y.
+    const int64_t A = c.A, B = c.B, C = c.C;
+    int x = from.x, y = from.y;
+    int64_t X = 2 * (int64_t)x, Y = 2 * (int64_t)y;
+    int64_t G = A * X * X + B * X * Y + C * Y * Y + 2 * c.D * X + 2 * c.E * Y + 4 * c.F;
+    int64_t Lx = 4 * A * X + 2 * B * Y + 4 * c.D;
+    int64_t Ly = 2 * B * X + 4 * C * Y + 4 * c.E;
+
+    // Pieces: the cuts ordered by how far the travel direction has turned
+    // since 'from' (it turns the same way all along a branch), then 'to'
+    const double TWO_PI = 6.28318530717958647692;
+    auto travel = [&](ConicPixel p, double& fx, double& fy) {
+        fx = 2.0 * A * p.x + (double)B * p.y + (double)c.D;
+        fy = (double)B * p.x + 2.0 * C * p.y + (double)c.E;
+        return std::atan2(fx * orientation, -fy * orientation);
+    };
+    double fx, fy, tfx, tfy;
+    double angle0 = travel(from, fx, fy), angleTo = travel(to, tfx, tfy);
+    double turn = ((double)A * fy * fy - (double)B * fx * fy + (double)C * fx * fx) * orientation < 0 ? -1 : 1;
+    auto turned = [&](double angle) {
+        double k = std::fmod((angle - angle0) * turn, TWO_PI);
+        return k < 0 ? k + TWO_PI : k;
+    };
+    bool closed = from.x == to.x && from.y == to.y;
+    double keyTo = closed ? TWO_PI : turned(angleTo);
+    TurnPoint ends[5];
+    int pieces = 0, cuts = conic_detail::axisTurns(c, orientation, ends);
+    for (int i = 0; i < cuts; ++i) {
+        double k = turned(ends[i].key);
+        if (k < keyTo) ends[pieces++] = { k, ends[i].x, ends[i].y };
+    }
+    for (int i = 1; i < pieces; ++i)
+        for (int j = i; j > 0 && ends[j].key < ends[j - 1].key; --j) std::swap(ends[j], ends[j - 1]);
+    ends[pieces++] = { keyTo, to.x, to.y };
+
+    conic_detail::SpanBuilder<Sink> spans{ sink, clip };
+    spans.add(x, y);
+    int64_t steps = 1;
+
+    auto stepX = [&](int s) { G += s * Lx + 4 * A; Lx += 8 * A * s; Ly += 4 * B * s; x += s; };
+    auto stepY = [&](int s) { G += s * Ly + 4 * C; Ly += 8 * C * s; Lx += 4 * B * s; y += s; };
+    // G at (X + hx, Y + hy), offsets in half pixels (Lx, Ly are multiples of 4)
+    auto at = [&](int64_t hx, int64_t hy) {
+        return G + hx * (Lx / 2) + hy * (Ly / 2) + A * hx * hx + B * hx * hy + C * hy * hy;
+    };
+
+    for (int piece = 0; piece < pieces; ++piece) {
+        const int ex = ends[piece].x, ey = ends[piece].y;
+        while (x != ex || y != ey) {
+            if (steps >= maxSteps) { spans.flush(); return -1; }
+            // Major axis and direction of the tangent here
+            int64_t tx = -Ly * orientation, ty = Lx * orientation;
+            bool xMajor = (tx < 0 ? -tx : tx) >= (ty < 0 ? -ty : ty);
+            int s = xMajor ? (tx > 0 ? 1 : -1) : (ty > 0 ? 1 : -1);
+            int qx = 0, qy = 0;
+            for (int attempt = 0; attempt < 2; ++attempt) {
+                // One step along the major axis, the minor one chosen from
+                // the midpoints on the new column (row)
+                if (xMajor) { qx = s; qy = minorStep(at(2 * s, -1), at(2 * s, 1)); }
+                else        { qy = s; qx = minorStep(at(-1, 2 * s), at(1, 2 * s)); }
+                if (attempt) break;
+                // If that pixel lies strictly past an octant boundary it
+                // must also pass the other octant's rule; if not, the curve
+                // turns within this step and the other axis steps instead
+                int64_t gx = Lx + 8 * A * qx + 4 * B * qy, gy = Ly + 4 * B * qx + 8 * C * qy;
+                int64_t agx = gx < 0 ? -gx : gx, agy = gy < 0 ? -gy : gy;
+                if (xMajor ? agx <= agy : agy <= agx) break;
+                bool ownRule = xMajor ? minorStep(at(2 * qx - 1, 2 * qy), at(2 * qx + 1, 2 * qy)) == 0
+                                      : minorStep(at(2 * qx, 2 * qy - 1), at(2 * qx, 2 * qy + 1)) == 0;
+                if (ownRule) break;
+                xMajor = !xMajor;
+                s = (xMajor ? -gy : gx) * orientation > 0 ? 1 : -1;
+            }
+            // Only toward the piece's end, and onto a pixel where the
+            // curve also runs that way: near a tip sharper than a pixel
+            // both sides lie in the same direction and pixels of the far
+            // side run backwards. There the gradient at pixel centers can
+            // also mislead the midpoint rule, which otherwise lands within
+            // half a pixel of the curve; if its pixel fails either test,
+            // take the allowed neighbour nearest the curve, running
+            // forward if any does.
+            int sx = ex > x ? 1 : ex < x ? -1 : 0, sy = ey > y ? 1 : ey < y ? -1 : 0;
+            auto forward = [&](int nx, int ny) {
+                int64_t gx = Lx + 8 * A * nx + 4 * B * ny, gy = Ly + 4 * B * nx + 8 * C * ny;
+                return (gx * sy - gy * sx) * orientation > 0;
+            };
+            // Within 3/4 pixel of the curve along the gradient's larger axis
+            auto near = [&](int nx, int ny) {
+                int64_t gx = Lx + 8 * A * nx + 4 * B * ny, gy = Ly + 4 * B * nx + 8 * C * ny, g = at(2 * nx, 2 * ny);
+                return 4 * (g < 0 ? -g : g) <= 3 * std::max(gx < 0 ? -gx : gx, gy < 0 ? -gy : gy);
+            };
+            if (qx != sx) qx = 0;
+            if (qy != sy) qy = 0;
+            if (!(qx || qy) || !forward(qx, qy) || !near(qx, qy)) {
+                int64_t best = -1;
+                bool bestForward = false;
+                for (int k = 0; k < 3; ++k) {
+                    int nx = k == 1 ? 0 : sx, ny = k == 0 ? 0 : sy;
+                    if (!nx && !ny) continue;
+                    int64_t d = at(2 * nx, 2 * ny);
+                    if (d < 0) d = -d;
+                    bool f = forward(nx, ny);
+                    if (best < 0 || (f && !bestForward) || (f == bestForward && d < best)) {
+                        best = d; bestForward = f; qx = nx; qy = ny;
+                    }
+                }
+            }
+            if (qx) stepX(qx);
+            if (qy) stepY(qy);
+            ++steps;
+            if (std::abs(x) > c.extent || std::abs(y) > c.extent) { spans.flush(); return -1; }
+            if (!(closed && piece == pieces - 1 && x == ex && y == ey)) spans.add(x, y);
+        }
+    }
+    spans.flush();
+    return steps;
+}
@@ -0,0 +1,193 @@
+// curve_tess.h
+// Adaptive tessellation of parametric curves into line strips. A segment
+// is split until the curve strays less than a pixel tolerance from its
+// chord, measured in window pixels of the current projection, so a curve
+// gets as many vertices as it shows detail on screen: a few dozen when it
+// is small, more when zoomed in, the same count wherever it is panned.
+//
+//   CachedCurve<QuadBezier> parabola(parabolaX(1, 0, 0, -3, 3));
+//   const auto& pts = parabola.points(CurveView::fromOrtho(l, r, b, t, w, h));
+//   glBegin(GL_LINE_STRIP); for (auto& p : pts) glVertex2f(p.x, p.y); glEnd();
+//
+// Curves are callables t -> CurvePoint: QuadBezier, CubicBezier, Conic
+// (rational quadratic: ellipse, parabola and hyperbola arcs), EllipseArc,
+// or any lambda. CachedCurve keeps the tessellation of the last few zoom
+// levels (half-octave steps of the pixel scale), each built for the
+// finest scale of its step.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+const float CURVE_TOLERANCE_PX = 0.25f;  // max chord deviation in pixels
+const int CURVE_MIN_SEGMENTS   = 4;      // initial split, so small features are not skipped
+const int CURVE_MAX_DEPTH      = 16;     // per initial segment
+const int CURVE_CACHE_LEVELS   = 8;      // zoom levels kept per curve
+
+struct CurvePoint {
+    float x, y;
+};
+
+// World units to window pixels, per axis
+struct CurveView {
+    float pxPerUnitX, pxPerUnitY;
+
+    static CurveView fromOrtho(float l, float r, float b, float t, int width, int height) {
+        return { width / std::fabs(r - l), height / std::fabs(t - b) };
+    }
+};
+
+// === Curves ===
+struct QuadBezier {
+    CurvePoint p0, p1, p2;
+    CurvePoint operator()(float t) const {
+        float s = 1 - t;
+        return { s * s * p0.x + 2 * s * t * p1.x + t * t * p2.x,
+                 s * s * p0.y + 2 * s * t * p1.y + t * t * p2.y };
+    }
+};
+
+struct CubicBezier {
+    CurvePoint p0, p1, p2, p3;
+    CurvePoint operator()(float t) const {
+        float s = 1 - t, a = s * s * s, b = 3 * s * s * t, c = 3 * s * t * t, d = t * t * t;
+        return { a * p0.x + b * p1.x + c * p2.x + d * p3.x, a * p0.y + b * p1.y + c * p2.y + d * p3.y };
+    }
+};
+
+// Rational quadratic Bezier: an ellipse arc for w < 1, a parabola for
+// w == 1, a hyperbola for w > 1
+struct Conic {
+    CurvePoint p0, p1, p2;
+    float w;
+    CurvePoint operator()(float t) const {
+        float s = 1 - t, a = s * s, b = 2 * s * t * w, c = t * t, d = a + b + c;
+        return { (a * p0.x + b * p1.x + c * p2.x) / d, (a * p0.y + b * p1.y + c * p2.y) / d };
+    }
+};
+
+// Angles in radians, t = 0..1 runs from a0 to a1
+struct EllipseArc {
+    float cx, cy, rx, ry, a0, a1;
+    CurvePoint operator()(float t) const {
+        float a = a0 + (a1 - a0) * t;
+        return { cx + rx * std::cos(a), cy + ry * std::sin(a) };
+    }
+};
+
+// x = a*y^2 + b*y + c for y in [y0, y1], exactly, as a quadratic Bezier
+inline QuadBezier parabolaX(float a, float b, float c, float y0, float y1) {
+    auto x = [&](float y) { return a * y * y + b * y + c; };
+    return { { x(y0), y0 }, { a * y0 * y1 + b * (y0 + y1) * 0.5f + c, (y0 + y1) * 0.5f }, { x(y1), y1 } };
+}
+
+// === Tessellation ===
+namespace curve_detail {
+
+// Pixel distance from p to the chord a-b
+inline float chordDeviation(const CurveView& v, CurvePoint a, CurvePoint b, CurvePoint p) {
+    float ax = a.x * v.pxPerUnitX, ay = a.y * v.pxPerUnitY;
+    float dx = b.x * v.pxPerUnitX - ax, dy = b.y * v.pxPerUnitY - ay;
+    float px = p.x * v.pxPerUnitX - ax, py = p.y * v.pxPerUnitY - ay;
+    float len2 = dx * dx + dy * dy;
+    float t = len2 > 0 ? std::min(std::max((px * dx + py * dy) / len2, 0.0f), 1.0f) : 0.0f;
+    float ex = px - t * dx, ey = py - t * dy;
+    return std::sqrt(ex * ex + ey * ey);
+}
+
+// Appends the points after 'a' up to and including 'b'. The deviation is
+// checked at the quarter points too, so an S-bend whose midpoint happens
+// to lie on the chord is still split.
+template <class Curve>
+void subdivide(const Curve& curve, const CurveView& v, float tol, float t0, CurvePoint a, float t1,
+               CurvePoint b, int depth, std::vector<CurvePoint>& out) {
+    float tm = 0.5f * (t0 + t1);
+    CurvePoint m = curve(tm);
+    if (depth < CURVE_MAX_DEPTH) {
+        float err = chordDeviation(v, a, b, m);
+        if (err <= tol) {
+            err = std::max(chordDeviation(v, a, b, curve(0.5f * (t0 + tm))),
+                           chordDeviation(v, a, b, curve(0.5f * (tm + t1))));
+        }
+        if (err > tol) {
+            subdivide(curve, v, tol, t0, a, tm, m, depth + 1, out);
+            subdivide(curve, v, tol, tm, m, t1, b, depth + 1, out);
+            return;
+        }
+    }
+    out.push_back(b);
+}
+
+} // namespace curve_detail
+
+// Line strip for 'curve' over [t0, t1], appended to 'out'
+template <class Curve>
+void tessellateCurve(const Curve& curve, float t0, float t1, const CurveView& view, float tolerancePx,
+                     std::vector<CurvePoint>& out) {
+    CurvePoint a = curve(t0);
+    out.push_back(a);
+    for (int i = 0; i < CURVE_MIN_SEGMENTS; ++i) {
+        float ta = t0 + (t1 - t0) * i / CURVE_MIN_SEGMENTS;
+        float tb = i + 1 == CURVE_MIN_SEGMENTS ? t1 : t0 + (t1 - t0) * (i + 1) / CURVE_MIN_SEGMENTS;
+        CurvePoint b = curve(tb);
+        curve_detail::subdivide(curve, view, tolerancePx, ta, a, tb, b, 0, out);
+        a = b;
+    }
+}
+
+// === Per-zoom cache ===
+template <class Curve>
+class CachedCurve {
+public:
+    explicit CachedCurve(Curve c, float t0 = 0.0f, float t1 = 1.0f, float tolerancePx = CURVE_TOLERANCE_PX)
+        : curve(c), tBegin(t0), tEnd(t1), tolerance(tolerancePx) {}
+
+    // Tessellation good for 'view'; rebuilt only when the zoom level is new
+    const std::vector<CurvePoint>& points(const CurveView& view) {
+        int lx = level(view.pxPerUnitX), ly = level(view.pxPerUnitY);
+        ++clock;
+        for (Entry& e : entries)
+            if (e.levelX == lx && e.levelY == ly) {
+                e.used = clock;
+                return e.points;
+            }
+
+        Entry* slot;
+        if ((int)entries.size() < CURVE_CACHE_LEVELS) {
+            entries.emplace_back();
+            slot = &entries.back();
+        } else {
+            slot = &*std::min_element(entries.begin(), entries.end(),
+                                      [](const Entry& a, const Entry& b) { return a.used < b.used; });
+        }
+        slot->levelX = lx; slot->levelY = ly; slot->used = clock;
+        slot->points.clear();
+        // Finest scale of the level, so every zoom within it meets the tolerance
+        CurveView fine = { levelScale(lx), levelScale(ly) };
+        tessellateCurve(curve, tBegin, tEnd, fine, tolerance, slot->points);
+        ++builds;
+        return slot->points;
+    }
+
+    // Tessellations built so far (cache misses)
+    uint64_t buildCount() const { return builds; }
+
+private:
+    struct Entry {
+        int levelX = 0, levelY = 0;
+        uint64_t used = 0;
+        std::vector<CurvePoint> points;
+    };
+
+    // Half-octave steps of the scale
+    static int level(float pxPerUnit) { return (int)std::ceil(std::log2(std::max(pxPerUnit, 1e-6f)) * 2.0f); }
+    static float levelScale(int level) { return std::exp2(level * 0.5f); }
+
+    Curve curve;
+    float tBegin, tEnd, tolerance;
+    std::vector<Entry> entries;
+    uint64_t clock = 0, builds = 0;
+};
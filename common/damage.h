@@ -0,0 +1,124 @@
+// damage.h
+// Damage tracking for partial redraws. Whatever changes on screen reports
+// its pixel bounds (before and after the change, if it moved); the tracker
+// merges them into a few rectangles. GL redraws their union under a
+// scissor box, the CPU backend only the SOFT_BIN tiles they touch
+// (TileMask), so the cost of a frame follows the size of the change.
+//
+//   damage.add(circleBounds());      // circle fill changed
+//   ...
+//   if (damage.isFull()) redrawAll(); else redraw(damage.bounds());
+//   damage.clear();
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "tile_scheduler.h"
+
+const int DAMAGE_MAX_RECTS = 8;   // beyond this, collapse to the bounding box
+
+// One flag per screen tile; set when the tile must be redrawn
+struct TileMask {
+    int tile = 64, tilesX = 0, tilesY = 0;
+    std::vector<uint8_t> bits;
+
+    void reset(int width, int height, int tileSize, bool value) {
+        tile = tileSize;
+        tilesX = (width + tile - 1) / tile;
+        tilesY = (height + tile - 1) / tile;
+        bits.assign((size_t)tilesX * tilesY, value ? 1 : 0);
+    }
+    void mark(const TileRect& r) {
+        if (r.x0 >= r.x1 || r.y0 >= r.y1) return;
+        int tx1 = std::min(tilesX - 1, (r.x1 - 1) / tile), ty1 = std::min(tilesY - 1, (r.y1 - 1) / tile);
+        for (int ty = std::max(0, r.y0 / tile); ty <= ty1; ++ty)
+            for (int tx = std::max(0, r.x0 / tile); tx <= tx1; ++tx)
+                bits[(size_t)ty * tilesX + tx] = 1;
+    }
+    bool test(int tx, int ty) const { return bits[(size_t)ty * tilesX + tx] != 0; }
+    // For a scheduler task: 'r' is one tile of this size or a piece of one
+    bool touches(const TileRect& r) const { return test(r.x0 / tile, r.y0 / tile); }
+};
+
+class DamageTracker {
+public:
+    // New screen size: everything is damaged
+    void resize(int w, int h) {
+        width = w; height = h;
+        addAll();
+    }
+
+    void addAll() {
+        full = true;
+        rects.clear();
+    }
+
+    // Pixel rectangle, clipped to the screen
+    void add(TileRect r) {
+        if (full) return;
+        r.x0 = std::max(r.x0, 0); r.y0 = std::max(r.y0, 0);
+        r.x1 = std::min(r.x1, width); r.y1 = std::min(r.y1, height);
+        if (r.x0 >= r.x1 || r.y0 >= r.y1) return;
+
+        // Absorb every rectangle the new one overlaps, until none is left
+        for (size_t i = 0; i < rects.size();) {
+            const TileRect& o = rects[i];
+            if (o.x0 <= r.x1 && r.x0 <= o.x1 && o.y0 <= r.y1 && r.y0 <= o.y1) {
+                r = unite(r, o);
+                rects.erase(rects.begin() + i);
+                i = 0;
+            } else {
+                ++i;
+            }
+        }
+        rects.push_back(r);
+        if ((int)rects.size() > DAMAGE_MAX_RECTS) {
+            TileRect b = bounds();
+            rects.assign(1, b);
+        }
+        // Mostly dirty anyway: a full redraw is simpler and no slower
+        int64_t area = 0;
+        for (const TileRect& d : rects) area += (int64_t)(d.x1 - d.x0) * (d.y1 - d.y0);
+        if (area * 4 >= (int64_t)width * height * 3) addAll();
+    }
+
+    // World-space box under an orthographic view of left/right/bottom/top,
+    // grown by 'pad' pixels for line width and anti-aliasing
+    void addWorld(const float view[4], float x0, float y0, float x1, float y1, int pad = 2) {
+        float sx = width / (view[1] - view[0]), sy = height / (view[3] - view[2]);
+        add({ (int)std::floor((x0 - view[0]) * sx) - pad, (int)std::floor((y0 - view[2]) * sy) - pad,
+              (int)std::ceil((x1 - view[0]) * sx) + pad, (int)std::ceil((y1 - view[2]) * sy) + pad });
+    }
+
+    bool empty() const { return !full && rects.empty(); }
+    bool isFull() const { return full; }
+    void clear() { full = false; rects.clear(); }
+
+    // Union of the damage (the whole screen when full)
+    TileRect bounds() const {
+        if (full) return { 0, 0, width, height };
+        TileRect b = { width, height, 0, 0 };
+        for (const TileRect& r : rects) b = unite(b, r);
+        return b;
+    }
+
+    // The merged rectangles; empty when full
+    const std::vector<TileRect>& regions() const { return rects; }
+
+    void buildTileMask(TileMask& mask, int tile) const {
+        mask.reset(width, height, tile, full);
+        for (const TileRect& r : rects) mask.mark(r);
+    }
+
+private:
+    static TileRect unite(const TileRect& a, const TileRect& b) {
+        return { std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1) };
+    }
+
+    int width = 0, height = 0;
+    bool full = true;
+    std::vector<TileRect> rects;
+};
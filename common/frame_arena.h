@@ -0,0 +1,215 @@
+// frame_arena.h
+// Per-frame bump allocator for transient geometry and text, with
+// std::pmr container aliases that draw from it.
+//
+//   FrameVector<Point> pts(&frameArena());  // or FrameString, FrameStack
+//   ...                                     // build, draw
+//   FRAME_ARENA_END();                      // end of display(): rewind
+//
+// Allocation is a pointer bump and deallocation is a no-op; everything
+// goes away at once when the frame ends. If a frame needs more than the
+// arena holds, the extra comes from the heap and the arena grows to fit
+// at the next reset, so a steady-state frame makes no heap allocations.
+//
+// Build with -DCOUNT_ALLOCATIONS to replace the global operator new with
+// a counting one and report heap allocations per frame at exit (C++
+// allocations only; malloc inside the GL driver is not seen). Define it
+// for single-file programs only: the replacement lives in this header.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <stack>
+#include <string>
+#include <string_view>
+#include <vector>
+
+const size_t FRAME_ARENA_DEFAULT = 256 * 1024;   // initial capacity in bytes
+
+class FrameArena : public std::pmr::memory_resource {
+public:
+    explicit FrameArena(size_t capacity = FRAME_ARENA_DEFAULT) { grow(capacity); }
+    ~FrameArena() override {
+        freeOverflow();
+        ::operator delete(base);
+    }
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Forget everything allocated since the last reset. Overflow blocks
+    // are released and the main block grows to cover this frame's peak.
+    void reset() {
+        size_t needed = used + overflowBytes;
+        peakBytes = std::max(peakBytes, needed);
+        if (overflow) {
+            freeOverflow();
+            ::operator delete(base);
+            grow(needed + needed / 2);
+        }
+        used = 0;
+    }
+
+    size_t capacity() const { return size; }
+    size_t peak() const { return std::max(peakBytes, used + overflowBytes); }
+    // Times the arena had to go to the heap (growth and overflow)
+    uint64_t heapAllocations() const { return heapAllocs; }
+
+private:
+    // Overflow blocks are chained through a header at their start
+    struct Block {
+        Block* next;
+        size_t align;
+    };
+
+    void* do_allocate(size_t bytes, size_t align) override {
+        size_t offset = (used + align - 1) & ~(align - 1);
+        if (offset + bytes <= size) {
+            used = offset + bytes;
+            return base + offset;
+        }
+        // Doesn't fit: a dedicated heap block until the next reset
+        align = std::max(align, alignof(Block));
+        size_t header = (sizeof(Block) + align - 1) & ~(align - 1);
+        char* mem = static_cast<char*>(::operator new(header + bytes, std::align_val_t(align)));
+        ++heapAllocs;
+        overflow = new (mem) Block{ overflow, align };
+        overflowBytes += bytes;
+        return mem + header;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}   // released by reset()
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    void grow(size_t capacity) {
+        size = std::max(capacity, (size_t)4096);
+        base = static_cast<char*>(::operator new(size));
+        ++heapAllocs;
+    }
+
+    void freeOverflow() {
+        while (overflow) {
+            Block* next = overflow->next;
+            ::operator delete(overflow, std::align_val_t(overflow->align));
+            overflow = next;
+        }
+        overflowBytes = 0;
+    }
+
+    char* base = nullptr;
+    size_t size = 0, used = 0;
+    Block* overflow = nullptr;           // newest first
+    size_t overflowBytes = 0, peakBytes = 0;
+    uint64_t heapAllocs = 0;
+};
+
+// The program's arena; single-threaded (use from the render thread only)
+inline FrameArena& frameArena() {
+    static FrameArena arena;
+    return arena;
+}
+
+template <class T> using FrameVector = std::pmr::vector<T>;
+template <class T> using FrameStack  = std::stack<T, std::pmr::vector<T>>;
+using FrameString = std::pmr::string;
+
+// === Text builder ===
+// Appends without going through std::to_string temporaries:
+//   FrameString s(&frameArena());
+//   appendText(s, "A(", x, ",", y, ")");
+inline void appendText(FrameString& out, std::string_view s) { out.append(s.data(), s.size()); }
+inline void appendText(FrameString& out, const char* s) { out.append(s); }
+inline void appendText(FrameString& out, char c) { out.push_back(c); }
+inline void appendText(FrameString& out, int v) {
+    char buf[16];
+    auto r = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, r.ptr);
+}
+template <class First, class... Rest>
+void appendText(FrameString& out, const First& first, const Rest&... rest) {
+    appendText(out, first);
+    (appendText(out, rest), ...);
+}
+
+// === Heap allocation counter ===
+inline std::atomic<uint64_t>& heapAllocationCount() {
+    static std::atomic<uint64_t> count{0};
+    return count;
+}
+
+#ifdef COUNT_ALLOCATIONS
+
+// Every replaced new goes through countedAlloc and every delete through
+// countedFree, a matched pair. They are kept out of line: once malloc or
+// free is inlined into a new or delete, GCC pairs the free with the
+// caller's operator new and warns (-Wmismatched-new-delete).
+namespace frame_arena_detail {
+__attribute__((noinline)) inline void* countedAlloc(std::size_t n, std::size_t align) {
+    heapAllocationCount().fetch_add(1, std::memory_order_relaxed);
+    void* p = align <= alignof(std::max_align_t) ? std::malloc(n ? n : 1)
+                                                 : std::aligned_alloc(align, (n + align - 1) / align * align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+__attribute__((noinline)) inline void countedFree(void* p) noexcept { std::free(p); }
+} // namespace frame_arena_detail
+
+void* operator new(std::size_t n) { return frame_arena_detail::countedAlloc(n, 1); }
+void* operator new(std::size_t n, std::align_val_t a) { return frame_arena_detail::countedAlloc(n, (size_t)a); }
+void operator delete(void* p) noexcept { frame_arena_detail::countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { frame_arena_detail::countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { frame_arena_detail::countedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { frame_arena_detail::countedFree(p); }
+
+// Heap allocations of each frame, printed at exit. The first frames pay
+// for one-time setup (driver shader compiles, reused buffers growing), so
+// they are reported separately.
+const size_t FRAME_ALLOC_WARMUP = 3;
+
+class FrameAllocationReport {
+public:
+    static FrameAllocationReport& get() {
+        static FrameAllocationReport r;
+        return r;
+    }
+    void endFrame() {
+        uint64_t now = heapAllocationCount().load(std::memory_order_relaxed);
+        perFrame.push_back(now - last);
+        last = heapAllocationCount().load(std::memory_order_relaxed);   // not counting our own push_back
+    }
+    ~FrameAllocationReport() {
+        if (perFrame.size() <= FRAME_ALLOC_WARMUP) return;
+        uint64_t warmup = 0, steadyMax = 0, steadyTotal = 0;
+        for (size_t i = 0; i < perFrame.size(); ++i) {
+            if (i < FRAME_ALLOC_WARMUP) { warmup += perFrame[i]; continue; }
+            steadyMax = std::max(steadyMax, perFrame[i]);
+            steadyTotal += perFrame[i];
+        }
+        printf("Heap allocations: %llu in startup + %zu warm-up frames, then max %llu per frame "
+               "(%llu over %zu frames); arena %zu KiB, peak %zu KiB\n",
+               (unsigned long long)warmup, FRAME_ALLOC_WARMUP, (unsigned long long)steadyMax,
+               (unsigned long long)steadyTotal, perFrame.size() - FRAME_ALLOC_WARMUP,
+               frameArena().capacity() / 1024, frameArena().peak() / 1024);
+    }
+
+private:
+    FrameAllocationReport() : last(0) { perFrame.reserve(1 << 16); }
+    std::vector<uint64_t> perFrame;
+    uint64_t last;
+};
+
+#define FRAME_ARENA_END() (frameArena().reset(), FrameAllocationReport::get().endFrame())
+
+#else
+
+#define FRAME_ARENA_END() frameArena().reset()
+
+#endif
@@ -0,0 +1,297 @@
+// frame_profiler.h
+// Frame timing and Chrome-trace instrumentation for the GLUT programs.
+//
+//   PROFILE_SCOPE("drawGrid");   // CPU time of the enclosing block
+//   PROFILE_FRAME_END();         // end of display(): closes the frame
+//
+// Build with -DENABLE_PROFILING to turn it on. Without it the macros
+// expand to nothing, so instrumented code pays zero overhead.
+// When enabled, GL timestamp queries (GL 3.3 / ARB_timer_query) also
+// measure GPU time per scope where the driver supports them. Queries come
+// from a recycled pool and are read PROFILE_GPU_LATENCY frames later, once
+// GL_QUERY_RESULT_AVAILABLE says so, so the CPU never stalls on the GPU.
+// Events are written as Chrome trace-event JSON (open in chrome://tracing
+// or Perfetto) to $PROFILE_TRACE, default "trace.json", every
+// PROFILE_EVENT_FLUSH events and at exit, when a p50/p95/p99 frame-time
+// summary is printed too; memory stays bounded however long the run.
+//
+// FrameHistogram is always available; the benchmark loops use it directly.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <string>
+#include <vector>
+
+// === Frame-time histogram ===
+// Keeps every sample (a few bytes per frame); percentiles sort a copy.
+class FrameHistogram {
+    std::vector<double> samples;
+
+public:
+    void add(double ms) { samples.push_back(ms); }
+    void clear() { samples.clear(); }
+    size_t count() const { return samples.size(); }
+
+    double total() const {
+        double t = 0;
+        for (double s : samples) t += s;
+        return t;
+    }
+
+    // Nearest-rank percentile, p in [0,100]
+    double percentile(double p) const {
+        if (samples.empty()) return 0;
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+        return sorted[std::min(sorted.size() - 1, rank ? rank - 1 : 0)];
+    }
+
+    void print(const char* label) const {
+        if (samples.empty()) return;
+        printf("%s: %zu frames, %.1f frames/s, p50 %.3f ms, p95 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+               label, samples.size(), samples.size() * 1000.0 / total(),
+               percentile(50), percentile(95), percentile(99), percentile(100));
+    }
+};
+
+#ifdef ENABLE_PROFILING
+
+#include <GL/gl.h>
+
+// Query entry points (GL 1.5 / 3.3). Declared here because glext.h only
+// provides prototypes if GL_GLEXT_PROTOTYPES was set before the first GL
+// include; libGL exports them on Linux.
+extern "C" {
+GLAPI void APIENTRY glGenQueries(GLsizei n, GLuint* ids);
+GLAPI void APIENTRY glDeleteQueries(GLsizei n, const GLuint* ids);
+GLAPI void APIENTRY glGetQueryiv(GLenum target, GLenum pname, GLint* params);
+GLAPI void APIENTRY glQueryCounter(GLuint id, GLenum target);
+GLAPI void APIENTRY glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params);
+}
+
+const int    PROFILE_GPU_LATENCY = 3;           // frames before a scope's GPU time is read
+const size_t PROFILE_GPU_MAX_PENDING = 4096;    // scopes waiting on the GPU; older ones lose GPU time
+const size_t PROFILE_EVENT_FLUSH = 1 << 14;     // events held before they go to the trace file
+const GLsizei PROFILE_QUERY_BLOCK = 64;         // queries generated at a time
+
+// === Profiler ===
+class FrameProfiler {
+public:
+    static FrameProfiler& get() {
+        static FrameProfiler p;
+        return p;
+    }
+
+    double nowUs() const {
+        return std::chrono::duration<double, std::micro>(clock::now() - start).count();
+    }
+
+    // GL timestamps need a current context and GL 3.3 / ARB_timer_query
+    bool gpuTimersAvailable() {
+        if (gpuChecked) return gpuOk;
+        const char* version = (const char*)glGetString(GL_VERSION);
+        if (!version) return false;                 // no context yet; ask again later
+        gpuChecked = true;
+        int major = 0, minor = 0;
+        sscanf(version, "%d.%d", &major, &minor);
+        GLint bits = 0;
+        if (major > 3 || (major == 3 && minor >= 3)) {
+            glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &bits);
+            gpuOk = bits > 0;
+        }
+        return gpuOk;
+    }
+
+    struct Scope {
+        uint64_t id;
+        const char* name;
+        double beginUs, endUs;
+        GLuint queries[2];      // GL timestamps (0 when unavailable)
+        int depth;
+        bool closed;
+        uint64_t frame;         // frame it closed in
+    };
+
+    uint64_t beginScope(const char* name) {
+        Scope s = { nextId++, name, nowUs(), 0, {0, 0}, depth++, false, 0 };
+        if (gpuTimersAvailable()) {
+            s.queries[0] = takeQuery();
+            s.queries[1] = takeQuery();
+            glQueryCounter(s.queries[0], GL_TIMESTAMP);
+        }
+        open.push_back(s);
+        return s.id;
+    }
+
+    void endScope(uint64_t id) {
+        // The scope being closed is almost always the newest unclosed one
+        for (size_t i = open.size(); i-- > 0; ) {
+            Scope& s = open[i];
+            if (s.id != id) continue;
+            if (s.queries[0]) glQueryCounter(s.queries[1], GL_TIMESTAMP);
+            s.endUs = nowUs();
+            s.closed = true;
+            break;
+        }
+        --depth;
+    }
+
+    // Record the frame in the histogram and move the scopes that have
+    // closed on: straight to the events without GPU timers, else to wait
+    // for their queries. Scopes still open (e.g. display() itself when this
+    // is called from inside it) carry over to the next frame.
+    void endFrame() {
+        double t = nowUs();
+        if (lastFrameUs >= 0) frames.add((t - lastFrameUs) / 1000.0);
+        lastFrameUs = t;
+
+        size_t kept = 0;
+        for (Scope& s : open) {
+            if (!s.closed) { open[kept++] = s; continue; }
+            s.frame = frameNo;
+            if (s.queries[0]) gpuPending.push_back(s);
+            else addEvent(resolve(s, false));
+        }
+        open.resize(kept);
+        resolveGpu();
+        addEvent({ "frame", t, 0, -1, -1 });
+        ++frameNo;
+    }
+
+    ~FrameProfiler() {
+        // The GL context may already be gone at exit: keep CPU times only
+        for (Scope& s : gpuPending) addEvent(resolve(s, false));
+        for (Scope& s : open)
+            if (s.closed) addEvent(resolve(s, false));
+        frames.print("Frame time");
+        flushEvents();
+        if (trace) {
+            fprintf(trace, "\n],\"displayTimeUnit\":\"ms\"}\n");
+            fclose(trace);
+        }
+    }
+
+private:
+    typedef std::chrono::steady_clock clock;
+    struct Event {
+        const char* name;
+        double tsUs, durUs, gpuUs;
+        int depth;
+    };
+
+    FrameProfiler() : start(clock::now()) {}
+
+    GLuint takeQuery() {
+        if (freeQueries.empty()) {
+            freeQueries.resize(PROFILE_QUERY_BLOCK);
+            glGenQueries(PROFILE_QUERY_BLOCK, freeQueries.data());
+        }
+        GLuint q = freeQueries.back();
+        freeQueries.pop_back();
+        return q;
+    }
+
+    bool queryReady(GLuint q) {
+        GLuint64 available = 0;
+        glGetQueryObjectui64v(q, GL_QUERY_RESULT_AVAILABLE, &available);
+        return available != 0;
+    }
+
+    // Read the GPU times of the scopes PROFILE_GPU_LATENCY or more frames
+    // old whose results have arrived; never waits. Scopes finish in order,
+    // so the first one not ready ends the pass, unless too many are
+    // pending: then the oldest are given up on.
+    void resolveGpu() {
+        size_t done = 0;
+        for (; done < gpuPending.size(); ++done) {
+            Scope& s = gpuPending[done];
+            bool old = frameNo - s.frame >= (uint64_t)PROFILE_GPU_LATENCY;
+            bool ready = old && queryReady(s.queries[1]) && queryReady(s.queries[0]);
+            if (!ready && gpuPending.size() - done <= PROFILE_GPU_MAX_PENDING) break;
+            addEvent(resolve(s, ready));
+            freeQueries.push_back(s.queries[0]);
+            freeQueries.push_back(s.queries[1]);
+        }
+        gpuPending.erase(gpuPending.begin(), gpuPending.begin() + done);
+    }
+
+    Event resolve(Scope& s, bool readGpu) {
+        Event e = { s.name, s.beginUs, s.endUs - s.beginUs, -1, s.depth };
+        if (s.queries[0] && readGpu) {
+            GLuint64 t0 = 0, t1 = 0;
+            glGetQueryObjectui64v(s.queries[0], GL_QUERY_RESULT, &t0);
+            glGetQueryObjectui64v(s.queries[1], GL_QUERY_RESULT, &t1);
+            e.gpuUs = (t1 - t0) / 1000.0;
+        }
+        return e;
+    }
+
+    void addEvent(const Event& e) {
+        events.push_back(e);
+        if (events.size() >= PROFILE_EVENT_FLUSH) flushEvents();
+    }
+
+    // Append the held events to the trace file, opened on first use
+    void flushEvents() {
+        if (!trace && !traceFailed) {
+            const char* file = getenv("PROFILE_TRACE");
+            if (!file) file = "trace.json";
+            trace = fopen(file, "w");
+            if (trace) fprintf(trace, "{\"traceEvents\":[\n");
+            else { fprintf(stderr, "profiler: cannot write %s\n", file); traceFailed = true; }
+        }
+        for (size_t i = 0; trace && i < events.size(); ++i) {
+            const Event& e = events[i];
+            if (written++) fprintf(trace, ",\n");
+            if (e.depth < 0)   // frame boundary: instant event
+                fprintf(trace, "{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":1}", e.tsUs);
+            else if (e.gpuUs >= 0)
+                fprintf(trace, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1,"
+                               "\"args\":{\"gpu_us\":%.3f}}", e.name, e.tsUs, e.durUs, e.gpuUs);
+            else
+                fprintf(trace, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":1}",
+                        e.name, e.tsUs, e.durUs);
+        }
+        events.clear();
+    }
+
+    clock::time_point start;
+    std::vector<Scope> open;         // scopes not yet closed this frame
+    std::deque<Scope> gpuPending;    // closed, GPU times not read yet (oldest first)
+    std::vector<GLuint> freeQueries; // recycled timestamp queries
+    std::vector<Event> events;       // recorded since the last flush
+    FrameHistogram frames;
+    FILE* trace = nullptr;
+    size_t written = 0;              // events in the trace file
+    bool traceFailed = false;
+    double lastFrameUs = -1;
+    uint64_t nextId = 0, frameNo = 0;
+    int depth = 0;
+    bool gpuChecked = false, gpuOk = false;
+};
+
+struct ProfileScope {
+    uint64_t index;
+    explicit ProfileScope(const char* name) : index(FrameProfiler::get().beginScope(name)) {}
+    ~ProfileScope() { FrameProfiler::get().endScope(index); }
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_FRAME_END() FrameProfiler::get().endFrame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+
+#endif
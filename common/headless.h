@@ -0,0 +1,214 @@
+// headless.h
+// Offscreen render mode for the GLUT demos.
+// With --headless the demo skips GLUT entirely: an EGL surfaceless context
+// (Mesa llvmpipe works fine) renders N frames into a framebuffer object,
+// each frame is written out as a PPM image, and frame timing is reported.
+// Link with -lEGL.
+//
+//   ./demo --headless [--frames N] [--size WxH] [--out prefix]
+
+#pragma once
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <GL/glut.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bitmap_font.h"
+
+struct HeadlessOptions {
+    int width, height;
+    int frames = 1;
+    std::string outPrefix = "frame";
+    HeadlessOptions(int w, int h) : width(w), height(h) {}
+};
+
+// True while running offscreen; GLUT calls must be skipped in that case.
+inline bool& headlessActive() {
+    static bool active = false;
+    return active;
+}
+
+// GLUT's bitmap fonts need an initialized GLUT display, so offscreen
+// text is drawn with the built-in 5x7 font (bitmap_font.h) instead, scaled
+// to about the GLUT font's size. Glyph shapes and widths differ from
+// GLUT's; positions and colors are the same.
+inline void bitmapCharacter(void* font, int c) {
+    if (!headlessActive()) { glutBitmapCharacter(font, c); return; }
+    int scale = 1;                                   // 8/10/12-pixel fonts
+    if (font == GLUT_BITMAP_9_BY_15 || font == GLUT_BITMAP_HELVETICA_18) scale = 2;
+    if (font == GLUT_BITMAP_TIMES_ROMAN_24) scale = 3;
+    drawBuiltinCharacter(c, scale);
+}
+
+// Finish a frame: swap or flush on screen, plain flush offscreen.
+inline void presentFrame(bool doubleBuffered) {
+    if (headlessActive()) glFlush();
+    else if (doubleBuffered) glutSwapBuffers();
+    else glFlush();
+}
+
+// Removes the headless flags from argv. Returns true if --headless was given.
+inline bool parseHeadlessArgs(int& argc, char** argv, HeadlessOptions& opts) {
+    bool headless = false;
+    int out = 1;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--headless") headless = true;
+        else if (a == "--frames" && i + 1 < argc) opts.frames = std::max(1, atoi(argv[++i]));
+        else if (a == "--size" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &opts.width, &opts.height) != 2) {
+                std::cerr << "--size expects WxH\n";
+                exit(1);
+            }
+        }
+        else if (a == "--out" && i + 1 < argc) opts.outPrefix = argv[++i];
+        else argv[out++] = argv[i];
+    }
+    argc = out;
+    return headless;
+}
+
+// Writes the currently bound read framebuffer as binary PPM (top row first).
+inline bool writeFramePPM(const std::string& file, int w, int h) {
+    static std::vector<unsigned char> rgb;   // reused, so frames after the first don't allocate
+    rgb.resize((size_t)w * h * 3);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+    FILE* f = fopen(file.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "P6\n%d %d\n255\n", w, h);
+    for (int y = h - 1; y >= 0; --y)
+        fwrite(rgb.data() + (size_t)y * w * 3, 1, (size_t)w * 3, f);
+    return fclose(f) == 0;
+}
+
+// === EGL context + FBO ===
+struct HeadlessContext {
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    GLuint fbo = 0, colorRb = 0, depthRb = 0;
+
+    bool create(int w, int h) {
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)
+            eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display == EGL_NO_DISPLAY)
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+            std::cerr << "headless: no EGL display\n";
+            return false;
+        }
+        // Desktop GL (compatibility profile) so the immediate-mode demos run unchanged
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            std::cerr << "headless: EGL has no desktop OpenGL\n";
+            return false;
+        }
+        EGLint cfgAttribs[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig config = nullptr;
+        EGLint count = 0;
+        eglChooseConfig(display, cfgAttribs, &config, 1, &count);
+        context = eglCreateContext(display, count ? config : (EGLConfig)0, EGL_NO_CONTEXT, nullptr);
+        if (context == EGL_NO_CONTEXT ||
+            !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+            std::cerr << "headless: cannot make a surfaceless context current\n";
+            return false;
+        }
+
+        auto genFramebuffers = (PFNGLGENFRAMEBUFFERSPROC)eglGetProcAddress("glGenFramebuffers");
+        auto bindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)eglGetProcAddress("glBindFramebuffer");
+        auto genRenderbuffers = (PFNGLGENRENDERBUFFERSPROC)eglGetProcAddress("glGenRenderbuffers");
+        auto bindRenderbuffer = (PFNGLBINDRENDERBUFFERPROC)eglGetProcAddress("glBindRenderbuffer");
+        auto renderbufferStorage = (PFNGLRENDERBUFFERSTORAGEPROC)eglGetProcAddress("glRenderbufferStorage");
+        auto framebufferRenderbuffer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)eglGetProcAddress("glFramebufferRenderbuffer");
+        auto checkStatus = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)eglGetProcAddress("glCheckFramebufferStatus");
+        if (!genFramebuffers || !bindFramebuffer || !genRenderbuffers || !checkStatus) {
+            std::cerr << "headless: framebuffer objects unavailable\n";
+            return false;
+        }
+
+        genFramebuffers(1, &fbo);
+        bindFramebuffer(GL_FRAMEBUFFER, fbo);
+        genRenderbuffers(1, &colorRb);
+        bindRenderbuffer(GL_RENDERBUFFER, colorRb);
+        renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+        framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRb);
+        genRenderbuffers(1, &depthRb);
+        bindRenderbuffer(GL_RENDERBUFFER, depthRb);
+        renderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, w, h);
+        framebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRb);
+        if (checkStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "headless: incomplete framebuffer\n";
+            return false;
+        }
+        glDrawBuffer(GL_COLOR_ATTACHMENT0);
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        return true;
+    }
+
+    ~HeadlessContext() {
+        if (display != EGL_NO_DISPLAY) {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (context != EGL_NO_CONTEXT) eglDestroyContext(display, context);
+            eglTerminate(display);
+        }
+    }
+};
+
+// === Offscreen frame loop ===
+// init/reshape may be null. Frame time covers display() plus glFinish();
+// writing the image is timed separately so it does not skew frames/s.
+inline int runHeadless(const HeadlessOptions& opts, void (*init)(),
+                       void (*reshape)(int, int), void (*display)()) {
+    headlessActive() = true;
+    HeadlessContext ctx;
+    if (!ctx.create(opts.width, opts.height)) return 1;
+    std::cout << "Headless: " << glGetString(GL_RENDERER) << ", "
+              << opts.width << "x" << opts.height << ", " << opts.frames << " frame(s)\n";
+
+    if (init) init();
+    glViewport(0, 0, opts.width, opts.height);
+    if (reshape) reshape(opts.width, opts.height);
+
+    using clock = std::chrono::steady_clock;
+    std::vector<double> frameMs;
+    frameMs.reserve(opts.frames);
+    double writeMs = 0;
+    std::string path = opts.outPrefix;
+    path.reserve(path.size() + 32);
+    for (int i = 0; i < opts.frames; ++i) {
+        auto t0 = clock::now();
+        display();
+        glFinish();
+        auto t1 = clock::now();
+        frameMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+
+        char name[32];
+        snprintf(name, sizeof(name), "_%04d.ppm", i);
+        path.resize(opts.outPrefix.size());
+        path += name;
+        if (!writeFramePPM(path, opts.width, opts.height)) {
+            std::cerr << "headless: cannot write " << path << "\n";
+            return 1;
+        }
+        writeMs += std::chrono::duration<double, std::milli>(clock::now() - t1).count();
+    }
+
+    double total = 0;
+    for (double ms : frameMs) total += ms;
+    std::sort(frameMs.begin(), frameMs.end());
+    printf("Rendered %d frame(s): %.1f frames/s, frame time avg %.3f ms, "
+           "min %.3f ms, max %.3f ms (image writes %.1f ms total)\n",
+           opts.frames, opts.frames * 1000.0 / total, total / opts.frames,
+           frameMs.front(), frameMs.back(), writeMs);
+    return 0;
+}
@@ -0,0 +1,391 @@
+// image_stream.h
+// Streaming image export: rows go to the file in bands as the caller
+// produces them, so an image never has to exist whole in memory and a
+// multi-gigapixel canvas can be written from its own storage band by band.
+//
+//   ImageStreamWriter out("big.png", width, height, 1, &scheduler);   // .pgm, .ppm or .png
+//   for (...each band, top to bottom...)
+//       out.writeRows(band.data(), rows, width);                     // rows x width bytes
+//   out.finish();
+//
+// Output goes through AlignedFileWriter: a 4 MiB page-aligned buffer
+// flushed with write(2) in whole-buffer pieces, no iostreams.
+//
+// PNG rows are Up-filtered into blocks of about 1 MiB, and each block
+// becomes its own IDAT chunk holding an independent deflate stream piece
+// (ended on a byte boundary, like pigz). Blocks are written in order;
+// their Adler-32s are combined for the zlib trailer.
+//
+// PNG is compressed only with -DENABLE_ZLIB (and -lz): the blocks are then
+// deflated in parallel on the tile scheduler while the caller renders the
+// next bands, at most two batches of blocks (one per worker each) held at
+// once. Without zlib the blocks are stored: a valid PNG, but as large as
+// the raw pixels (1.6 GB for a 40000x40000 gray image), and the scheduler
+// is not used since storing is only a copy.
+//
+// Gray images have 1 channel, RGB 3; PGM takes gray, PPM RGB, PNG either.
+// Linux/POSIX only (write(2)). Errors throw std::runtime_error.
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include "tile_scheduler.h"
+#ifdef ENABLE_ZLIB
+#include <zlib.h>
+#endif
+
+const size_t IMAGE_STREAM_BUFFER_BYTES = 4 << 20;    // AlignedFileWriter buffer
+const size_t IMAGE_STREAM_ALIGN = 4096;
+const size_t IMAGE_STREAM_BLOCK_BYTES = 1 << 20;     // filtered PNG bytes per IDAT block
+
+enum class ImageFormat { PGM, PPM, PNG };
+
+// Format from the file extension (.pgm, .ppm, .png)
+inline ImageFormat imageFormatFor(const std::string& path) {
+    std::string ext = path.substr(path.find_last_of('.') + 1);
+    for (char& c : ext) c = (char)tolower((unsigned char)c);
+    if (ext == "pgm") return ImageFormat::PGM;
+    if (ext == "ppm") return ImageFormat::PPM;
+    if (ext == "png") return ImageFormat::PNG;
+    throw std::runtime_error("Unknown image format: " + path);
+}
+
+namespace image_stream_detail {
+
+inline uint32_t crc32(uint32_t crc, const uint8_t* p, size_t n) {
+    static const std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; ++i) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+const uint32_t ADLER_BASE = 65521;
+
+inline uint32_t adler32(uint32_t adler, const uint8_t* p, size_t n) {
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    while (n) {
+        size_t k = std::min<size_t>(n, 5552);    // largest run without 32-bit overflow
+        n -= k;
+        while (k--) { a += *p++; b += a; }
+        a %= ADLER_BASE; b %= ADLER_BASE;
+    }
+    return (b << 16) | a;
+}
+
+// Adler-32 of A followed by B, from adler(A), adler(B) and B's length
+inline uint32_t adler32Combine(uint32_t adlerA, uint32_t adlerB, uint64_t lengthB) {
+    uint32_t rem = (uint32_t)(lengthB % ADLER_BASE);
+    uint32_t a = adlerA & 0xFFFF;
+    uint32_t b = (uint32_t)(((uint64_t)rem * a) % ADLER_BASE);
+    a += (adlerB & 0xFFFF) + ADLER_BASE - 1;
+    b += (adlerA >> 16) + (adlerB >> 16) + ADLER_BASE - rem;
+    if (a >= ADLER_BASE) a -= ADLER_BASE;
+    if (a >= ADLER_BASE) a -= ADLER_BASE;
+    if (b >= 2 * ADLER_BASE) b -= 2 * ADLER_BASE;
+    if (b >= ADLER_BASE) b -= ADLER_BASE;
+    return (b << 16) | a;
+}
+
+inline void putBE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24); p[1] = (uint8_t)(v >> 16); p[2] = (uint8_t)(v >> 8); p[3] = (uint8_t)v;
+}
+
+// PNG chunk: length, type, data, CRC over type and data
+inline void appendChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t n) {
+    size_t at = out.size();
+    out.resize(at + 12 + n);
+    putBE32(&out[at], (uint32_t)n);
+    memcpy(&out[at + 4], type, 4);
+    if (n) memcpy(&out[at + 8], data, n);
+    putBE32(&out[at + 8 + n], crc32(0, &out[at + 4], 4 + n));
+}
+
+// One block of filtered PNG rows and, once compressed, its IDAT chunk
+struct PngBlock {
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> chunk;
+    uint32_t adler = 1;
+    bool last = false;      // holds the image's final row: ends the deflate stream
+};
+
+// Deflate 'raw' (a piece of one stream, byte-aligned at both ends) into
+// 'out' after its first 'offset' bytes
+inline void deflateBlock(const std::vector<uint8_t>& raw, bool last, std::vector<uint8_t>& out, size_t offset) {
+#ifdef ENABLE_ZLIB
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw std::runtime_error("deflateInit2 failed");
+    out.resize(offset + deflateBound(&zs, raw.size()) + 16);
+    zs.next_in = const_cast<uint8_t*>(raw.data());
+    zs.avail_in = (uInt)raw.size();
+    zs.next_out = out.data() + offset;
+    zs.avail_out = (uInt)(out.size() - offset);
+    int rc = deflate(&zs, last ? Z_FINISH : Z_SYNC_FLUSH);
+    size_t produced = zs.total_out;
+    deflateEnd(&zs);
+    if (rc != (last ? Z_STREAM_END : Z_OK) || zs.avail_in) throw std::runtime_error("deflate failed");
+    out.resize(offset + produced);
+#else
+    // Stored blocks of up to 65535 bytes: 1 header byte, LEN, ~LEN, data
+    size_t pieces = std::max<size_t>(1, (raw.size() + 65534) / 65535);
+    out.resize(offset + raw.size() + 5 * pieces);
+    uint8_t* o = out.data() + offset;
+    for (size_t i = 0, at = 0; i < pieces; ++i) {
+        size_t n = std::min<size_t>(65535, raw.size() - at);
+        *o++ = last && i + 1 == pieces ? 1 : 0;
+        o[0] = (uint8_t)n; o[1] = (uint8_t)(n >> 8);
+        o[2] = (uint8_t)~n; o[3] = (uint8_t)(~n >> 8);
+        o += 4;
+        if (n) memcpy(o, raw.data() + at, n);
+        o += n; at += n;
+    }
+#endif
+}
+
+// Compress a block into a complete IDAT chunk
+inline void compressBlock(PngBlock& b) {
+    b.adler = adler32(1, b.raw.data(), b.raw.size());
+    deflateBlock(b.raw, b.last, b.chunk, 8);
+    size_t n = b.chunk.size() - 8;
+    putBE32(&b.chunk[0], (uint32_t)n);
+    memcpy(&b.chunk[4], "IDAT", 4);
+    b.chunk.resize(8 + n + 4);
+    putBE32(&b.chunk[8 + n], crc32(0, &b.chunk[4], 4 + n));
+}
+
+} // namespace image_stream_detail
+
+// Buffered file output: a page-aligned buffer flushed by write(2) a whole
+// buffer at a time
+class AlignedFileWriter {
+public:
+    explicit AlignedFileWriter(const std::string& path, size_t bufferBytes = IMAGE_STREAM_BUFFER_BYTES)
+        : name(path), capacity(bufferBytes) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+        if (posix_memalign((void**)&buffer, IMAGE_STREAM_ALIGN, capacity)) {
+            ::close(fd);
+            throw std::runtime_error("Out of memory for " + path);
+        }
+    }
+    ~AlignedFileWriter() {
+        if (fd >= 0) ::close(fd);       // close() not called: an error path, drop the rest
+        free(buffer);
+    }
+    AlignedFileWriter(const AlignedFileWriter&) = delete;
+    AlignedFileWriter& operator=(const AlignedFileWriter&) = delete;
+
+    void write(const void* data, size_t n) {
+        const uint8_t* p = (const uint8_t*)data;
+        while (n) {
+            size_t k = std::min(n, capacity - used);
+            memcpy(buffer + used, p, k);
+            used += k; p += k; n -= k;
+            if (used == capacity) flush();
+        }
+    }
+
+    void flush() {
+        size_t done = 0;
+        while (done < used) {
+            ssize_t k = ::write(fd, buffer + done, used - done);
+            if (k < 0 && errno == EINTR) continue;
+            if (k <= 0) throw std::runtime_error("Cannot write file: " + name);
+            done += (size_t)k;
+        }
+        total += used;
+        used = 0;
+    }
+
+    // Flush and close; errors are reported here, not by the destructor
+    void close() {
+        flush();
+        int rc = ::close(fd);
+        fd = -1;
+        if (rc) throw std::runtime_error("Cannot write file: " + name);
+    }
+
+    uint64_t written() const { return total + used; }
+
+private:
+    std::string name;
+    int fd = -1;
+    uint8_t* buffer = nullptr;
+    size_t capacity, used = 0;
+    uint64_t total = 0;
+};
+
+class ImageStreamWriter {
+public:
+    // Format from the extension; 'scheduler' compresses PNG blocks in
+    // parallel (null: on the calling thread; ignored without zlib)
+    ImageStreamWriter(const std::string& path, int width, int height, int channels,
+                      TileScheduler* scheduler = nullptr)
+        : format(imageFormatFor(path)), file(path), width_(width), height_(height),
+          rowBytes((size_t)width * channels), sched(scheduler) {
+        using namespace image_stream_detail;
+        if (width <= 0 || height <= 0 || (channels != 1 && channels != 3))
+            throw std::runtime_error("Invalid image size or channels: " + path);
+        if ((format == ImageFormat::PGM && channels != 1) || (format == ImageFormat::PPM && channels != 3))
+            throw std::runtime_error("PGM needs 1 channel and PPM 3: " + path);
+        if (format != ImageFormat::PNG) {
+            std::string header = (format == ImageFormat::PGM ? "P5\n" : "P6\n") +
+                                 std::to_string(width) + ' ' + std::to_string(height) + "\n255\n";
+            file.write(header.data(), header.size());
+            return;
+        }
+        static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        uint8_t ihdr[13];
+        putBE32(ihdr, (uint32_t)width);
+        putBE32(ihdr + 4, (uint32_t)height);
+        ihdr[8] = 8;                            // bit depth
+        ihdr[9] = channels == 1 ? 0 : 2;        // gray / RGB
+        ihdr[10] = ihdr[11] = ihdr[12] = 0;     // deflate, adaptive filtering, no interlace
+        static const uint8_t zlibHeader[2] = { 0x78, 0x01 };
+        std::vector<uint8_t> out(signature, signature + 8);
+        appendChunk(out, "IHDR", ihdr, sizeof(ihdr));
+        appendChunk(out, "IDAT", zlibHeader, 2);
+        file.write(out.data(), out.size());
+
+        prevRow.assign(rowBytes, 0);
+#ifndef ENABLE_ZLIB
+        sched = nullptr;        // stored blocks: nothing to compress
+#endif
+        blocksPerBatch = sched ? sched->workerCount() + 1 : 1;
+    }
+
+    ~ImageStreamWriter() {
+        for (Batch& b : batches)                 // left in flight by an exception
+            if (b.frame) sched->wait(b.frame);
+    }
+    ImageStreamWriter(const ImageStreamWriter&) = delete;
+    ImageStreamWriter& operator=(const ImageStreamWriter&) = delete;
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int rowsWritten() const { return rows; }
+
+    // The next 'count' rows, top to bottom: width * channels bytes each,
+    // 'stride' bytes apart
+    void writeRows(const uint8_t* data, int count, size_t stride) {
+        if (count > height_ - rows) throw std::runtime_error("More rows than the image height");
+        for (int i = 0; i < count; ++i, ++rows) {
+            const uint8_t* row = data + (size_t)i * stride;
+            if (format != ImageFormat::PNG) { file.write(row, rowBytes); continue; }
+            addPngRow(row);
+        }
+    }
+
+    // Writes what is still pending and closes the file; every row must
+    // have been written
+    void finish() {
+        using namespace image_stream_detail;
+        if (rows != height_) throw std::runtime_error("Image finished before its last row");
+        if (format == ImageFormat::PNG) {
+            submitBatch();                       // the final batch (ends with the last block)
+            drainBatch(inFlight);
+            uint8_t trailer[4];
+            putBE32(trailer, adler);
+            std::vector<uint8_t> out;
+            appendChunk(out, "IDAT", trailer, 4);
+            appendChunk(out, "IEND", nullptr, 0);
+            file.write(out.data(), out.size());
+        }
+        file.close();
+    }
+
+    uint64_t bytesWritten() const { return file.written(); }
+
+private:
+    typedef image_stream_detail::PngBlock PngBlock;
+
+    struct Batch {
+        std::vector<PngBlock> blocks;
+        size_t used = 0;        // blocks filled
+        TileFrame frame;
+    };
+
+    // Up filter: each byte minus the one above it
+    void addPngRow(const uint8_t* row) {
+        Batch& b = batches[filling];
+        if (b.blocks.size() < blocksPerBatch) b.blocks.resize(blocksPerBatch);
+        PngBlock& block = b.blocks[b.used];
+        size_t at = block.raw.size();
+        block.raw.resize(at + 1 + rowBytes);
+        uint8_t* o = &block.raw[at];
+        *o++ = 2;
+        for (size_t i = 0; i < rowBytes; ++i) o[i] = (uint8_t)(row[i] - prevRow[i]);
+        memcpy(prevRow.data(), row, rowBytes);
+
+        block.last = rows + 1 == height_;
+        if (block.raw.size() >= IMAGE_STREAM_BLOCK_BYTES && !block.last && ++b.used == blocksPerBatch)
+            submitBatch();
+    }
+
+    // Start compressing the filling batch, after writing out the one before
+    // it; the caller goes on filling the other batch meanwhile
+    void submitBatch() {
+        Batch& b = batches[filling];
+        if (b.used < b.blocks.size() && !b.blocks[b.used].raw.empty()) ++b.used;
+        drainBatch(inFlight);
+        if (sched) {
+            b.frame = sched->submit((int)b.used, 1, 1, [&b](const TileRect& r, TileContext&) {
+                image_stream_detail::compressBlock(b.blocks[r.x0]);
+            });
+        } else {
+            for (size_t i = 0; i < b.used; ++i) image_stream_detail::compressBlock(b.blocks[i]);
+        }
+        inFlight = filling;
+        filling ^= 1;
+    }
+
+    // Wait for a submitted batch and write its chunks in order
+    void drainBatch(int index) {
+        if (index < 0) return;
+        Batch& b = batches[index];
+        if (b.frame) { sched->wait(b.frame); b.frame = nullptr; }
+        for (size_t i = 0; i < b.used; ++i) {
+            PngBlock& block = b.blocks[i];
+            file.write(block.chunk.data(), block.chunk.size());
+            adler = image_stream_detail::adler32Combine(adler, block.adler, block.raw.size());
+            block.raw.clear();
+            block.chunk.clear();
+            block.last = false;
+        }
+        b.used = 0;
+        inFlight = -1;
+    }
+
+    ImageFormat format;
+    AlignedFileWriter file;
+    int width_, height_;
+    size_t rowBytes;
+    TileScheduler* sched;
+    int rows = 0;
+
+    // PNG state
+    std::vector<uint8_t> prevRow;
+    size_t blocksPerBatch = 1;
+    Batch batches[2];
+    int filling = 0, inFlight = -1;
+    uint32_t adler = 1;         // of all filtered bytes written so far
+};
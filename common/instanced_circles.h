@@ -0,0 +1,291 @@
+// instanced_circles.h
+// Draws very large numbers of (optionally textured) circles.
+// GL path: one shared unit-circle mesh plus one per-instance attribute
+// buffer (center, radius, texture offset, tint), all drawn by a single
+// glDrawArraysInstanced call. Needs GL 3.3 (or ARB_instanced_arrays);
+// include after defining GL_GLEXT_PROTOTYPES, before any other GL header.
+// CPU path: instances are binned into screen tiles with a counting sort,
+// then each tile draws its circles in submission order; with a
+// TileScheduler the tiles run in parallel and crowded tiles split.
+
+#pragma once
+
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "soft_raster.h"
+
+struct CircleInstance {
+    float cx, cy, radius;        // world units
+    float texOffsetU, texOffsetV;
+    uint32_t tint;               // RGBA8, see packRGBA()
+};
+
+// === GL path ===
+class InstancedCircleRenderer {
+public:
+    // Compiles the shaders and builds the unit mesh; needs a current context
+    bool init(int segments = 64) {
+        const char* vsSrc =
+            "#version 130\n"
+            "in vec2 unitPos;\n"
+            "in vec3 instCircle;\n"          // cx, cy, radius
+            "in vec2 instTexOffset;\n"
+            "in vec4 instTint;\n"
+            "out vec2 uv;\n"
+            "out vec4 tint;\n"
+            "void main() {\n"
+            "    vec2 p = instCircle.xy + unitPos * instCircle.z;\n"
+            "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);\n"
+            "    uv = unitPos * 0.5 + 0.5 + instTexOffset;\n"
+            "    tint = instTint;\n"
+            "}\n";
+        const char* fsSrc =
+            "#version 130\n"
+            "uniform sampler2D tex;\n"
+            "uniform bool textured;\n"
+            "in vec2 uv;\n"
+            "in vec4 tint;\n"
+            "void main() {\n"
+            "    gl_FragColor = textured ? tint * texture(tex, uv) : tint;\n"
+            "}\n";
+        GLuint vs = compile(GL_VERTEX_SHADER, vsSrc), fs = compile(GL_FRAGMENT_SHADER, fsSrc);
+        if (!vs || !fs) return false;
+        program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glBindAttribLocation(program, 0, "unitPos");
+        glBindAttribLocation(program, 1, "instCircle");
+        glBindAttribLocation(program, 2, "instTexOffset");
+        glBindAttribLocation(program, 3, "instTint");
+        glLinkProgram(program);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        GLint ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) { std::cerr << "instanced circles: link failed\n"; return false; }
+        texturedLoc = glGetUniformLocation(program, "textured");
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "tex"), 0);
+        glUseProgram(0);
+
+        // Unit circle as a triangle fan: center + closed rim
+        std::vector<float> mesh = { 0.0f, 0.0f };
+        for (int i = 0; i <= segments; ++i) {
+            float a = 2.0f * 3.14159265f * i / segments;
+            mesh.push_back(std::cos(a));
+            mesh.push_back(std::sin(a));
+        }
+        meshVertices = segments + 2;
+
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+        glGenBuffers(1, &meshVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, meshVbo);
+        glBufferData(GL_ARRAY_BUFFER, mesh.size() * sizeof(float), mesh.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+        glGenBuffers(1, &instanceVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        const GLsizei stride = sizeof(CircleInstance);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(CircleInstance, cx));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(CircleInstance, texOffsetU));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(CircleInstance, tint));
+        for (GLuint a = 1; a <= 3; ++a) glVertexAttribDivisor(a, 1);
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return true;
+    }
+
+    // Copy instance data to the GPU; only needed when it changes
+    void upload(const std::vector<CircleInstance>& instances) {
+        upload(instances.data(), instances.size());
+    }
+    void upload(const CircleInstance* instances, size_t count) {
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, count * sizeof(CircleInstance), instances, GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        instanceCount = (GLsizei)count;
+    }
+
+    // Draw every uploaded instance; 'texture' 0 means untextured
+    void draw(GLuint texture) {
+        if (!program || !instanceCount) return;
+        glUseProgram(program);
+        glUniform1i(texturedLoc, texture ? 1 : 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindVertexArray(vao);
+        glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, meshVertices, instanceCount);
+        glBindVertexArray(0);
+        glUseProgram(0);
+    }
+
+private:
+    GLuint program = 0, vao = 0, meshVbo = 0, instanceVbo = 0;
+    GLint texturedLoc = -1;
+    GLsizei meshVertices = 0, instanceCount = 0;
+
+    static GLuint compile(GLenum type, const char* src) {
+        GLuint s = glCreateShader(type);
+        glShaderSource(s, 1, &src, nullptr);
+        glCompileShader(s);
+        GLint ok = 0;
+        glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(s, sizeof(log), nullptr, log);
+            std::cerr << "instanced circles: shader error: " << log << "\n";
+            glDeleteShader(s);
+            return 0;
+        }
+        return s;
+    }
+};
+
+// === CPU path ===
+const int INSTANCE_BIN = 64;   // bin edge in pixels
+
+// Instances per screen bin in compressed form: bin b owns
+// indices[start[b] .. start[b+1]), in submission order.
+struct CircleBins {
+    int binsX = 0, binsY = 0;
+    std::vector<uint32_t> start;
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> cursor;   // scratch for binning, kept for its capacity
+};
+
+// Pixel bounding box of one instance, clamped to the framebuffer (empty if off-screen)
+inline SoftRect circlePixelBounds(const CircleInstance& c, const SoftFramebuffer& fb, const SoftOrtho& view) {
+    float px = (c.cx - view.left) * view.sx(fb), py = (c.cy - view.bottom) * view.sy(fb);
+    float rx = c.radius * view.sx(fb), ry = c.radius * view.sy(fb);
+    SoftRect r;
+    r.x0 = std::max(0, (int)std::floor(px - rx));
+    r.y0 = std::max(0, (int)std::floor(py - ry));
+    r.x1 = std::min(fb.width,  (int)std::ceil(px + rx) + 1);
+    r.y1 = std::min(fb.height, (int)std::ceil(py + ry) + 1);
+    return r;
+}
+
+// Two passes over the instances (count, then scatter) so no per-bin
+// vectors are allocated; rebinning reuses the arrays in 'bins'
+inline void binCircleInstances(const std::vector<CircleInstance>& instances,
+                               const SoftFramebuffer& fb, const SoftOrtho& view, CircleBins& bins) {
+    bins.binsX = (fb.width + INSTANCE_BIN - 1) / INSTANCE_BIN;
+    bins.binsY = (fb.height + INSTANCE_BIN - 1) / INSTANCE_BIN;
+    size_t binCount = (size_t)bins.binsX * bins.binsY;
+    bins.start.assign(binCount + 1, 0);
+
+    auto forEachBin = [&](const CircleInstance& c, auto fn) {
+        SoftRect r = circlePixelBounds(c, fb, view);
+        if (r.x0 >= r.x1 || r.y0 >= r.y1) return;
+        for (int by = r.y0 / INSTANCE_BIN; by <= (r.y1 - 1) / INSTANCE_BIN; ++by)
+            for (int bx = r.x0 / INSTANCE_BIN; bx <= (r.x1 - 1) / INSTANCE_BIN; ++bx)
+                fn((size_t)by * bins.binsX + bx);
+    };
+    for (const CircleInstance& c : instances)
+        forEachBin(c, [&](size_t b) { ++bins.start[b + 1]; });
+    for (size_t b = 0; b < binCount; ++b) bins.start[b + 1] += bins.start[b];
+
+    bins.indices.resize(bins.start[binCount]);
+    bins.cursor.assign(bins.start.begin(), bins.start.end() - 1);
+    for (uint32_t i = 0; i < instances.size(); ++i)
+        forEachBin(instances[i], [&](size_t b) { bins.indices[bins.cursor[b]++] = i; });
+}
+
+// Draw the circles of one bin, limited to 'tile' (the bin or a piece of
+// it). Pixel centers inside the circle are filled; rows are solved
+// analytically so there is no per-pixel inside test.
+inline void rasterCircleBin(SoftFramebuffer& fb, const std::vector<CircleInstance>& instances,
+                            const CircleBins& bins, int bin, const SoftTexture* texture,
+                            const SoftOrtho& view, SoftRect tile) {
+    int tx0 = tile.x0, ty0 = tile.y0, tx1 = tile.x1, ty1 = tile.y1;
+    float sx = view.sx(fb), sy = view.sy(fb);
+
+    for (uint32_t k = bins.start[bin]; k < bins.start[bin + 1]; ++k) {
+        const CircleInstance& c = instances[bins.indices[k]];
+        float cx = (c.cx - view.left) * sx, cy = (c.cy - view.bottom) * sy;
+        float rx = c.radius * sx, ry = c.radius * sy;
+        if (rx <= 0 || ry <= 0) continue;
+        float tint[4];
+        for (int ch = 0; ch < 4; ++ch) tint[ch] = ((c.tint >> (8 * ch)) & 0xFF) / 255.0f;
+        // Texels per pixel for the mip level, as the GL path would pick
+        float lod = texture ? std::log2(std::max(1e-6f, texture->width() / (2.0f * rx))) : 0.0f;
+
+        int y0 = std::max(ty0, (int)std::ceil(cy - ry - 0.5f));
+        int y1 = std::min(ty1 - 1, (int)std::floor(cy + ry - 0.5f));
+        for (int y = y0; y <= y1; ++y) {
+            float dy = (y + 0.5f - cy) / ry;
+            float half = 1.0f - dy * dy;
+            if (half < 0) continue;
+            half = std::sqrt(half) * rx;
+            int x0 = std::max(tx0, (int)std::ceil(cx - half - 0.5f));
+            int x1 = std::min(tx1 - 1, (int)std::floor(cx + half - 0.5f));
+            uint32_t* row = fb.row(y);
+            if (!texture) {
+                uint32_t color = c.tint;
+                for (int x = x0; x <= x1; ++x) row[x] = color;
+                continue;
+            }
+            float v = dy * 0.5f + 0.5f + c.texOffsetV;
+            for (int x = x0; x <= x1; ++x) {
+                float u = (x + 0.5f - cx) / rx * 0.5f + 0.5f + c.texOffsetU;
+                float t[4];
+                texture->sample(u, v, lod, t);
+                row[x] = packRGBA(t[0] * tint[0], t[1] * tint[1], t[2] * tint[2], t[3] * tint[3]);
+            }
+        }
+    }
+}
+
+inline void rasterCircleBin(SoftFramebuffer& fb, const std::vector<CircleInstance>& instances,
+                            const CircleBins& bins, int bin, const SoftTexture* texture,
+                            const SoftOrtho& view) {
+    int x0 = bin % bins.binsX * INSTANCE_BIN, y0 = bin / bins.binsX * INSTANCE_BIN;
+    SoftRect tile = { x0, y0, std::min(fb.width, x0 + INSTANCE_BIN), std::min(fb.height, y0 + INSTANCE_BIN) };
+    rasterCircleBin(fb, instances, bins, bin, texture, view, tile);
+}
+
+// Draw already binned instances, on 'scheduler' if given and only in the
+// bins marked in 'mask' if given (its tile must be INSTANCE_BIN)
+inline void rasterCircleBins(SoftFramebuffer& fb, const std::vector<CircleInstance>& instances,
+                             const CircleBins& bins, const SoftTexture* texture, const SoftOrtho& view,
+                             TileScheduler* scheduler = nullptr, const TileMask* mask = nullptr) {
+    if (!scheduler || scheduler->workerCount() < 2) {
+        for (int b = 0; b < bins.binsX * bins.binsY; ++b)
+            if (!mask || mask->bits[b]) rasterCircleBin(fb, instances, bins, b, texture, view);
+        return;
+    }
+    scheduler->run(fb.width, fb.height, INSTANCE_BIN, [&](const SoftRect& r, TileContext& ctx) {
+        if (mask && !mask->touches(r)) return;
+        int b = r.y0 / INSTANCE_BIN * bins.binsX + r.x0 / INSTANCE_BIN;
+        int64_t work = (int64_t)(bins.start[b + 1] - bins.start[b]) * (r.x1 - r.x0) * (r.y1 - r.y0) /
+                       (INSTANCE_BIN * INSTANCE_BIN);
+        if (work > SOFT_SPLIT_WORK && r.x1 - r.x0 > SOFT_SPLIT_MIN) {
+            ctx.splitQuadrants(r);
+            return;
+        }
+        rasterCircleBin(fb, instances, bins, b, texture, view, r);
+    });
+}
+
+// Bin and draw all instances on the CPU, on 'scheduler' if given
+inline void rasterCircleInstances(SoftFramebuffer& fb, const std::vector<CircleInstance>& instances,
+                                  const SoftTexture* texture, const SoftOrtho& view, CircleBins& bins,
+                                  TileScheduler* scheduler = nullptr) {
+    binCircleInstances(instances, fb, view, bins);
+    rasterCircleBins(fb, instances, bins, texture, view, scheduler);
+}
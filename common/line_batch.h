@@ -0,0 +1,286 @@
+// line_batch.h
+// Bulk line rasterization for very large segment sets (millions of
+// segments into one 8-bit image, datashader style), in parallel on the
+// TileScheduler by one of two strategies:
+//
+//   Tiled    every segment is binned into the tiles it crosses and each
+//            tile draws its bin clipped to itself. Nothing is shared, but
+//            a long segment is binned and set up once per tile it crosses.
+//   Private  each worker takes slices of the segment list and draws them
+//            whole into its own framebuffer; the framebuffers are then
+//            merged band by band with SSE2 (max for coverage, OR for
+//            masks). A segment costs one setup, but every worker's
+//            framebuffer has to be cleared and merged.
+//
+// chooseStrategy() estimates the overhead of each from the average segment
+// length, the segment count and the image size: short segments (time
+// series) favour Private, whose cost is a fixed merge, long ones favour
+// Tiled, which keeps each tile in cache. Private is also ruled out when
+// the per-worker framebuffers would exceed LINE_PRIVATE_MAX_BYTES. Both give
+// exactly the same image, since max and OR do not depend on order.
+//
+//   LineBatchRenderer lines(&scheduler);
+//   lines.resize(w, h);
+//   lines.draw(segments.data(), segments.size(), LineMerge::Max, image.data());
+//
+// LineMerge::Max draws fixed-point Wu lines (line_kernels.h) and keeps the
+// larger coverage per pixel; LineMerge::Or draws Bresenham lines and ORs
+// 'bits' into each pixel, so several masks can share one image.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "line_kernels.h"
+#include "tile_scheduler.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const int LINE_TILE = 128;                                   // Tiled strategy tile size
+const int LINE_MERGE_BAND = 16;                              // rows per merge task
+const size_t LINE_PRIVATE_MAX_BYTES = size_t(1) << 30;       // all private framebuffers together
+const int LINE_SLICES_PER_WORKER = 4;                        // Private: slices for load balance
+
+// Cost model weights, in nanoseconds (measured on x86-64 at -O2); only
+// what differs between the strategies is modelled
+const double LINE_COST_BIN = 10.0;          // binning a segment into one tile (serial)
+const double LINE_COST_TILE_SETUP = 20.0;   // clipping and starting a segment in one more tile
+const double LINE_COST_MERGE_BYTE = 0.8;    // merging and clearing one private framebuffer byte
+const double LINE_COST_MISS = 1.8;          // extra per pixel step when the image is out of cache
+const size_t LINE_CACHE_BYTES = size_t(1) << 20;   // a tile always fits; a private image may not
+
+// Pixel coordinates, row 0 at the bottom
+struct LineSegment {
+    int x0, y0, x1, y1;
+};
+
+enum class LineMerge { Max, Or };
+enum class LineStrategy { Auto, Serial, Tiled, Private };
+
+// Which strategy ran and what the model expected, for reports
+struct LineBatchStats {
+    LineStrategy strategy;
+    double averageLength;                        // pixels along the major axis
+    double tiledOverheadMs, privateOverheadMs;   // beyond the pixel work both share; < 0: ruled out
+};
+
+namespace line_batch_detail {
+
+// Into one image, clipped to a rectangle
+struct MaxPlot {
+    uint8_t* pixels;
+    int width;
+    TileRect clip;
+    void operator()(int x, int y, Coverage8 a) const {
+        if (x >= clip.x0 && x < clip.x1 && y >= clip.y0 && y < clip.y1) {
+            uint8_t& d = pixels[(size_t)y * width + x];
+            d = std::max(d, a.value);
+        }
+    }
+};
+
+struct OrPlot {
+    uint8_t* pixels;
+    int width;
+    TileRect clip;
+    uint8_t bits;
+    void operator()(int x, int y, Coverage8) const {
+        if (x >= clip.x0 && x < clip.x1 && y >= clip.y0 && y < clip.y1)
+            pixels[(size_t)y * width + x] |= bits;
+    }
+};
+
+template <class Plot>
+inline void drawSegment(const LineSegment& s, LineMerge mode, Plot& plot, const TileRect* clip) {
+    if (mode == LineMerge::Max) {
+        if (clip) drawWuLineFixed(s.x0, s.y0, s.x1, s.y1, plot, *clip);
+        else drawWuLineFixed(s.x0, s.y0, s.x1, s.y1, plot);
+    } else {
+        if (clip) drawBresenhamLine(s.x0, s.y0, s.x1, s.y1, plot, *clip);
+        else drawBresenhamLine(s.x0, s.y0, s.x1, s.y1, plot);
+    }
+}
+
+// dst = max(dst, src) or dst |= src over n bytes, then src = 0
+inline void mergeAndClear(uint8_t* dst, uint8_t* src, size_t n, LineMerge mode) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(s, zero)) == 0xFFFF) continue;   // nothing drawn here
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        d = mode == LineMerge::Max ? _mm_max_epu8(d, s) : _mm_or_si128(d, s);
+        _mm_storeu_si128((__m128i*)(dst + i), d);
+        _mm_storeu_si128((__m128i*)(src + i), zero);
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = mode == LineMerge::Max ? std::max(dst[i], src[i]) : (uint8_t)(dst[i] | src[i]);
+        src[i] = 0;
+    }
+}
+
+inline int tileOf(int v, int limit) { return std::min(std::max(v, 0), limit - 1) / LINE_TILE; }
+
+} // namespace line_batch_detail
+
+class LineBatchRenderer {
+public:
+    // Without a scheduler everything is drawn serially on the caller
+    explicit LineBatchRenderer(TileScheduler* s = nullptr) : scheduler(s) {}
+
+    void resize(int w, int h) {
+        width = w; height = h;
+        tilesX = (w + LINE_TILE - 1) / LINE_TILE;
+        tilesY = (h + LINE_TILE - 1) / LINE_TILE;
+        bins.assign((size_t)tilesX * tilesY, {});
+        privateImages.clear();
+        privateUsed.clear();
+    }
+
+    // Expected cost of each strategy for these segments; returns the
+    // cheaper one (Serial without a scheduler)
+    LineStrategy chooseStrategy(const LineSegment* segs, size_t n, LineBatchStats* stats = nullptr) const {
+        // The model needs only the mean length; a strided sample is plenty
+        size_t step = std::max<size_t>(1, n / 4096);
+        double sum = 0;
+        size_t sampled = 0;
+        for (size_t i = 0; i < n; i += step, ++sampled)
+            sum += std::max(std::abs(segs[i].x1 - segs[i].x0), std::abs(segs[i].y1 - segs[i].y0));
+        double length = sampled ? sum / sampled : 0.0;
+
+        int workers = scheduler ? scheduler->workerCount() + 1 : 1;
+        // Tiled: a segment crosses about 1 + length / tile tiles along its
+        // major axis, plus some where its minor extent straddles a tile
+        // edge. Binning each crossing is serial; starting the segment again
+        // in every tile is spread over the workers.
+        double crossings = n * (1.0 + 1.5 * length / LINE_TILE);
+        double tiled = crossings * (LINE_COST_BIN + LINE_COST_TILE_SETUP / workers);
+        // Private: every worker's framebuffer is merged (and cleared) in
+        // parallel bands; tiles stay in cache, a whole image may not, and
+        // long segments wander all over it
+        double bytes = (double)width * height;
+        double priv = bytes * LINE_COST_MERGE_BYTE;
+        if (bytes > (double)LINE_CACHE_BYTES) priv += n * length * LINE_COST_MISS / workers;
+        bool fits = bytes * workers <= (double)LINE_PRIVATE_MAX_BYTES;
+
+        LineStrategy s = !scheduler ? LineStrategy::Serial
+                       : (fits && priv < tiled) ? LineStrategy::Private : LineStrategy::Tiled;
+        if (stats) *stats = { s, length, tiled * 1e-6, fits ? priv * 1e-6 : -1.0 };
+        return s;
+    }
+
+    // Draw the segments into 'image' (width x height bytes, row 0 first),
+    // combining with what is there. Returns the strategy used.
+    LineStrategy draw(const LineSegment* segs, size_t n, LineMerge mode, uint8_t* image, uint8_t bits = 0xFF,
+                      LineStrategy strategy = LineStrategy::Auto) {
+        if (strategy == LineStrategy::Auto) strategy = chooseStrategy(segs, n);
+        if (!scheduler) strategy = LineStrategy::Serial;
+        switch (strategy) {
+          case LineStrategy::Private: drawPrivate(segs, n, mode, image, bits); break;
+          case LineStrategy::Tiled: drawTiled(segs, n, mode, image, bits); break;
+          default: drawRange(segs, 0, n, mode, image, bits, { 0, 0, width, height }, nullptr); break;
+        }
+        return strategy;
+    }
+
+private:
+    void drawRange(const LineSegment* segs, size_t begin, size_t end, LineMerge mode, uint8_t* image, uint8_t bits,
+                   const TileRect& rect, const TileRect* clip) {
+        using namespace line_batch_detail;
+        if (mode == LineMerge::Max) {
+            MaxPlot plot = { image, width, rect };
+            for (size_t i = begin; i < end; ++i) drawSegment(segs[i], mode, plot, clip);
+        } else {
+            OrPlot plot = { image, width, rect, bits };
+            for (size_t i = begin; i < end; ++i) drawSegment(segs[i], mode, plot, clip);
+        }
+    }
+
+    // === Tiled ===
+    void drawTiled(const LineSegment* segs, size_t n, LineMerge mode, uint8_t* image, uint8_t bits) {
+        for (auto& b : bins) b.clear();
+        for (size_t i = 0; i < n; ++i) binSegment(segs[i], (uint32_t)i);
+
+        scheduler->run(width, height, LINE_TILE, [&](const TileRect& r, TileContext&) {
+            const std::vector<uint32_t>& bin = bins[(size_t)(r.y0 / LINE_TILE) * tilesX + r.x0 / LINE_TILE];
+            if (mode == LineMerge::Max) {
+                line_batch_detail::MaxPlot plot = { image, width, r };
+                for (uint32_t i : bin) line_batch_detail::drawSegment(segs[i], mode, plot, &r);
+            } else {
+                line_batch_detail::OrPlot plot = { image, width, r, bits };
+                for (uint32_t i : bin) line_batch_detail::drawSegment(segs[i], mode, plot, &r);
+            }
+        });
+    }
+
+    // Add segment i to every tile it may touch: walk the major axis one
+    // tile column (or row) at a time and take the minor range there, with
+    // a pixel of margin for the second Wu pixel and rounding
+    void binSegment(const LineSegment& s, uint32_t index) {
+        using line_batch_detail::tileOf;
+        bool steep = std::abs(s.y1 - s.y0) > std::abs(s.x1 - s.x0);
+        int m0 = steep ? s.y0 : s.x0, n0 = steep ? s.x0 : s.y0;
+        int m1 = steep ? s.y1 : s.x1, n1 = steep ? s.x1 : s.y1;
+        if (m0 > m1) { std::swap(m0, m1); std::swap(n0, n1); }
+        int majorLimit = steep ? height : width, minorLimit = steep ? width : height;
+        if (m1 < 0 || m0 >= majorLimit) return;
+        if (std::max(n0, n1) + 1 < 0 || std::min(n0, n1) - 1 >= minorLimit) return;
+
+        double slope = m1 == m0 ? 0.0 : double(n1 - n0) / (m1 - m0);
+        int from = std::max(m0, 0), to = std::min(m1, majorLimit - 1);
+        for (int t = from / LINE_TILE; t <= to / LINE_TILE; ++t) {
+            int lo = std::max(from, t * LINE_TILE), hi = std::min(to, t * LINE_TILE + LINE_TILE - 1);
+            double na = n0 + slope * (lo - m0), nb = n0 + slope * (hi - m0);
+            int nMin = (int)std::floor(std::min(na, nb)) - 1, nMax = (int)std::ceil(std::max(na, nb)) + 1;
+            if (nMax < 0 || nMin >= minorLimit) continue;
+            int u0 = tileOf(nMin, minorLimit), u1 = tileOf(nMax, minorLimit);
+            for (int u = u0; u <= u1; ++u) {
+                int tx = steep ? u : t, ty = steep ? t : u;
+                bins[(size_t)ty * tilesX + tx].push_back(index);
+            }
+        }
+    }
+
+    // === Private framebuffers ===
+    void drawPrivate(const LineSegment* segs, size_t n, LineMerge mode, uint8_t* image, uint8_t bits) {
+        int slots = scheduler->workerCount() + 1;               // + the waiting caller
+        size_t bytes = (size_t)width * height;
+        if ((int)privateImages.size() != slots) {
+            privateImages.assign(slots, std::vector<uint8_t>());
+            privateUsed.assign(slots, 0);
+        }
+
+        // Slices of the segment list as a 1-pixel-high "frame" of tasks
+        int slices = std::max(1, std::min<int>((int)std::min<size_t>(n, INT32_MAX), slots * LINE_SLICES_PER_WORKER));
+        scheduler->run(slices, 1, 1, [&](const TileRect& r, TileContext& ctx) {
+            int w = ctx.worker();
+            std::vector<uint8_t>& own = privateImages[w];
+            if (own.size() != bytes) own.assign(bytes, 0);      // kept zero between draws
+            privateUsed[w] = 1;
+            size_t begin = n * r.x0 / slices, end = n * r.x1 / slices;
+            drawRange(segs, begin, end, mode, own.data(), bits, { 0, 0, width, height }, nullptr);
+        });
+
+        // Merge the used framebuffers band by band, clearing them for next time
+        int bands = (height + LINE_MERGE_BAND - 1) / LINE_MERGE_BAND;
+        scheduler->run(bands, 1, 1, [&](const TileRect& r, TileContext&) {
+            size_t first = (size_t)r.x0 * LINE_MERGE_BAND * width;
+            size_t last = std::min((size_t)r.x1 * LINE_MERGE_BAND, (size_t)height) * width;
+            for (size_t w = 0; w < privateImages.size(); ++w)
+                if (privateUsed[w])
+                    line_batch_detail::mergeAndClear(image + first, privateImages[w].data() + first, last - first, mode);
+        });
+        std::fill(privateUsed.begin(), privateUsed.end(), 0);
+    }
+
+    TileScheduler* scheduler;
+    int width = 0, height = 0, tilesX = 0, tilesY = 0;
+    std::vector<std::vector<uint32_t>> bins;                // Tiled: segment indices per tile
+    std::vector<std::vector<uint8_t>> privateImages;        // Private: one framebuffer per worker slot
+    std::vector<char> privateUsed;
+};
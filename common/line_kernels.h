@@ -0,0 +1,352 @@
+// line_kernels.h
+// Xiaolin Wu and Gupta-Sproull anti-aliased lines as templates on the
+// octant and on the plot policy. The dispatcher looks at the line once
+// (steep or shallow, step directions) and calls the kernel instantiated
+// for that octant, so the per-pixel loop has no 'steep ? ... : ...' and
+// no call through a sink pointer: the policy's plot is inlined.
+//
+//   CanvasPlot canvas = { pixels, width, height };
+//   drawWuLine(x0, y0, x1, y1, canvas);
+//   drawGuptaSproullLine(x0, y0, x1, y1, [](int x, int y, float c) { ... });
+//
+// A plot policy is anything callable as plot(x, y, coverage), coverage in
+// [0, 1]: the structs below, or a lambda. drawWuLineFixed() is the
+// integer-only Wu for targets where float is slow: it calls
+// plot(x, y, Coverage8{ a }) with a in 0..255, which the structs below
+// also accept, as does drawBresenhamLine(). The integer kernels can draw
+// just the part of a line inside a clip rectangle, for tiled rendering.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+// 8-bit coverage from the fixed-point kernel, 255 = fully covered
+struct Coverage8 {
+    uint8_t value;
+};
+
+// === Plot policies ===
+// Overwrite 8-bit intensity (row 0 at the bottom), skipping pixels outside
+struct CanvasPlot {
+    uint8_t* pixels;
+    int width, height;
+    void operator()(int x, int y, float c) const {
+        if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height)
+            pixels[(size_t)y * width + x] = (uint8_t)(c * 255.0f + 0.5f);
+    }
+    void operator()(int x, int y, Coverage8 a) const {
+        if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height)
+            pixels[(size_t)y * width + x] = a.value;
+    }
+};
+
+// Blend coverage over what is there: dst += c * (255 - dst)
+struct CoverageBlendPlot {
+    uint8_t* pixels;
+    int width, height;
+    void operator()(int x, int y, float c) const {
+        if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height) {
+            uint8_t& d = pixels[(size_t)y * width + x];
+            d = (uint8_t)(d + c * (255 - d) + 0.5f);
+        }
+    }
+    void operator()(int x, int y, Coverage8 a) const {
+        if ((unsigned)x < (unsigned)width && (unsigned)y < (unsigned)height) {
+            uint8_t& d = pixels[(size_t)y * width + x];
+            d = (uint8_t)(d + (a.value * (255 - d) + 127) / 255);
+        }
+    }
+};
+
+// Pixels at least half covered (the aliased core of the line), merged into
+// horizontal runs: sink(y, x0, x1), x1 exclusive. Call flush() at the end.
+template <class Sink>
+struct SpanPlot {
+    Sink sink;
+    int y = 0, x0 = 0, x1 = 0;
+    bool open = false;
+
+    explicit SpanPlot(Sink s) : sink(s) {}
+    void operator()(int x, int py, float c) {
+        if (c < 0.5f) return;
+        if (open && py == y && x == x1) { ++x1; return; }
+        flush();
+        y = py; x0 = x; x1 = x + 1;
+        open = true;
+    }
+    void operator()(int x, int py, Coverage8 a) { (*this)(x, py, a.value >= 128 ? 1.0f : 0.0f); }
+    void flush() {
+        if (open) sink(y, x0, x1);
+        open = false;
+    }
+};
+
+// Number of plots and total coverage, for tests and benchmarks
+struct CountPlot {
+    uint64_t plots = 0;
+    double coverage = 0;
+    void operator()(int, int, float c) { ++plots; coverage += c; }
+    void operator()(int, int, Coverage8 a) { ++plots; coverage += a.value * (1.0 / 255); }
+};
+
+namespace line_detail {
+
+inline int ipart(float x) { return (int)std::floor(x); }
+inline float fpart(float x) { return x - std::floor(x); }
+inline float rfpart(float x) { return 1.0f - fpart(x); }
+
+// Plot in line space: 'major' runs along the long axis
+template <bool Steep, class Plot, class Coverage>
+inline void put(Plot& plot, int major, int minor, Coverage c) {
+    if constexpr (Steep) plot(minor, major, c);
+    else plot(major, minor, c);
+}
+
+// Wu, already swapped so that x is the major axis and x0 <= x1
+template <bool Steep, class Plot>
+void wuKernel(float x0, float y0, float x1, float y1, Plot& plot) {
+    float dx = x1 - x0, dy = y1 - y0;
+    float gradient = dx == 0.0f ? 1.0f : dy / dx;
+
+    // First endpoint
+    float xend = std::round(x0);
+    float yend = y0 + gradient * (xend - x0);
+    float xgap = rfpart(x0 + 0.5f);
+    int xpxl1 = (int)xend, ypxl1 = ipart(yend);
+    put<Steep>(plot, xpxl1, ypxl1, rfpart(yend) * xgap);
+    put<Steep>(plot, xpxl1, ypxl1 + 1, fpart(yend) * xgap);
+    // The minor coordinate relative to the first pixel, from the step count
+    // rather than accumulated: summing the gradient in float drifts by tens
+    // of 8-bit steps on long lines
+    float intery0 = yend - (float)ypxl1;
+
+    // Second endpoint
+    xend = std::round(x1);
+    yend = y1 + gradient * (xend - x1);
+    xgap = fpart(x1 + 0.5f);
+    int xpxl2 = (int)xend, ypxl2 = ipart(yend);
+
+    for (int x = xpxl1 + 1; x < xpxl2; ++x) {
+        float intery = intery0 + gradient * (float)(x - xpxl1);
+        int base = ipart(intery);
+        float f = intery - (float)base;
+        put<Steep>(plot, x, ypxl1 + base, 1.0f - f);
+        put<Steep>(plot, x, ypxl1 + base + 1, f);
+    }
+
+    put<Steep>(plot, xpxl2, ypxl2, rfpart(yend) * xgap);
+    put<Steep>(plot, xpxl2, ypxl2 + 1, fpart(yend) * xgap);
+}
+
+// Intensity from the distance to the line center, falling to 0 at 1.5 widths
+inline float gsIntensity(float distance, float lineWidth) {
+    float maxDistance = 1.5f * lineWidth;
+    return std::max(0.0f, 1.0f - distance / maxDistance);
+}
+
+// Gupta-Sproull for one octant: x is the major axis (after the steep
+// swap), XStep and YStep the directions of the major and minor steps
+template <bool Steep, int XStep, int YStep, class Plot>
+void guptaSproullKernel(int x0, int y0, int x1, int y1, int dx, int dy, float lineWidth, Plot& plot) {
+    float gradient = dx == 0 ? 0.0f : float(dy) / dx;
+    float intery = y0 + YStep * gradient;
+    int x = x0;
+
+    put<Steep>(plot, x, y0, 1.0f);   // first pixel, full intensity
+    for (int i = 1; i <= dx; ++i) {
+        x += XStep;
+        float base = std::floor(intery);
+        float d = intery - base;
+        put<Steep>(plot, x, (int)base, gsIntensity(d, lineWidth));
+        put<Steep>(plot, x, (int)base + 1, gsIntensity(1.0f - d, lineWidth));
+        intery += YStep * gradient;
+    }
+    put<Steep>(plot, x1, y1, 1.0f);  // last pixel
+}
+
+// Wu in fixed point for integer endpoints, x0 <= x1 and x the major axis
+// (after the steep swap); YStep is the direction of the minor axis. The
+// fractional part of the minor coordinate lives in a 16-bit accumulator,
+// as in Wu's paper, plus the remainder of dy*65536/dx carried exactly, so
+// long lines do not drift. Coverage comes from the accumulator's high bits.
+// Only major steps kFirst..kLast (0..dx) are drawn; the state at kFirst
+// comes in closed form, so a line can be drawn piece by piece.
+template <bool Steep, int YStep, class Plot>
+void wuFixedKernel(int x0, int y0, int x1, int y1, Plot& plot, int kFirst, int kLast) {
+    uint32_t dx = (uint32_t)(x1 - x0), dy = (uint32_t)(YStep * (y1 - y0));
+    kFirst = std::max(kFirst, 0);
+    kLast = std::min(kLast, (int)dx);
+    if (kFirst > kLast) return;
+
+    // Endpoints sit on pixel centers: half the pixel's length is covered
+    if (kFirst == 0) {
+        put<Steep>(plot, x0, y0, Coverage8{ 128 });
+        put<Steep>(plot, x0, y0 + 1, Coverage8{ 0 });
+    }
+
+    int kBegin = std::max(kFirst, 1), kEnd = std::min(kLast + 1, (int)dx);
+    if (kBegin < kEnd) {
+        uint64_t scaled = (uint64_t)dy << 16;
+        uint32_t whole = (uint32_t)(scaled / dx);               // 0..65536
+        uint32_t adj = whole & 0xFFFF, adjRem = (uint32_t)(scaled % dx);
+        int stepWhole = (int)(whole >> 16);                      // 1 only at 45 degrees
+        // State after kBegin - 1 steps: floor(k*dy*65536/dx) and its remainder
+        uint64_t before = (uint64_t)(kBegin - 1) * scaled;
+        uint32_t acc = (uint32_t)(before / dx) & 0xFFFF, rem = (uint32_t)(before % dx);
+        int y = y0 + YStep * (int)((before / dx) >> 16);
+        for (int x = x0 + kBegin; x < x0 + kEnd; ++x) {
+            rem += adjRem;
+            uint32_t carry = rem >= dx;
+            rem -= dx & (0u - carry);
+            acc += adj + carry;
+            y += YStep * (stepWhole + (int)(acc >> 16));
+            acc &= 0xFFFF;
+            // round(fraction * 255) = (acc * 255 + 32768) >> 16, by shifts
+            uint32_t a = (acc - (acc >> 8) + 128) >> 8;
+            if constexpr (YStep > 0) {
+                put<Steep>(plot, x, y, Coverage8{ (uint8_t)(255 - a) });
+                put<Steep>(plot, x, y + 1, Coverage8{ (uint8_t)a });
+            } else {
+                // Below y by the fraction: the pair is (y - 1, y) unless on a row
+                uint32_t nz = acc != 0;
+                uint32_t lower = 255 - ((255 - a) & (0u - nz));
+                put<Steep>(plot, x, y - (int)nz, Coverage8{ (uint8_t)lower });
+                put<Steep>(plot, x, y - (int)nz + 1, Coverage8{ (uint8_t)(255 - lower) });
+            }
+        }
+    }
+
+    if (kLast == (int)dx && dx > 0) {
+        put<Steep>(plot, x1, y1, Coverage8{ 128 });
+        put<Steep>(plot, x1, y1 + 1, Coverage8{ 0 });
+    }
+}
+
+// Bresenham (midpoint rule, ties rounding away from y0) for x0 <= x1 and
+// x the major axis, major steps kFirst..kLast; plots full coverage
+template <bool Steep, int YStep, class Plot>
+void bresenhamKernel(int x0, int y0, int x1, int y1, Plot& plot, int kFirst, int kLast) {
+    int64_t dx = x1 - x0, dy = YStep * (y1 - y0);
+    kFirst = std::max(kFirst, 0);
+    kLast = std::min<int64_t>(kLast, dx);
+    if (kFirst > kLast) return;
+    if (dx == 0) { put<Steep>(plot, x0, y0, Coverage8{ 255 }); return; }
+    // minor(k) = y0 + floor((2*k*dy + dx) / (2*dx)), e the remainder
+    int64_t num = 2 * kFirst * dy + dx, twoDx = 2 * dx, twoDy = 2 * dy;
+    int y = y0 + YStep * (int)(num / twoDx);
+    int64_t e = num % twoDx;
+    for (int x = x0 + kFirst; x <= x0 + kLast; ++x) {
+        put<Steep>(plot, x, y, Coverage8{ 255 });
+        e += twoDy;
+        int64_t steps = e >= twoDx;       // dy <= dx: at most one minor step
+        e -= twoDx & -steps;
+        y += YStep * (int)steps;
+    }
+}
+
+// Octant dispatch for the integer kernels, with the major steps to draw
+// taken from a clip rectangle (any type with x0, y0, x1, y1, half-open)
+template <template <bool, int> class Kernel, class Plot, class Rect>
+void dispatchInteger(int x0, int y0, int x1, int y1, Plot& plot, const Rect* clip) {
+    bool steep = std::abs(y1 - y0) > std::abs(x1 - x0);
+    if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+    if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+    int kFirst = 0, kLast = x1 - x0;
+    if (clip) {
+        int lo = steep ? clip->y0 : clip->x0, hi = steep ? clip->y1 : clip->x1;
+        kFirst = std::max(kFirst, lo - x0);
+        kLast = std::min(kLast, hi - 1 - x0);
+    }
+    switch ((steep ? 2 : 0) | (y1 >= y0 ? 1 : 0)) {
+      case 0: Kernel<false, -1>::run(x0, y0, x1, y1, plot, kFirst, kLast); break;
+      case 1: Kernel<false,  1>::run(x0, y0, x1, y1, plot, kFirst, kLast); break;
+      case 2: Kernel<true,  -1>::run(x0, y0, x1, y1, plot, kFirst, kLast); break;
+      case 3: Kernel<true,   1>::run(x0, y0, x1, y1, plot, kFirst, kLast); break;
+    }
+}
+
+template <bool Steep, int YStep>
+struct WuFixed {
+    template <class Plot>
+    static void run(int x0, int y0, int x1, int y1, Plot& plot, int kFirst, int kLast) {
+        wuFixedKernel<Steep, YStep>(x0, y0, x1, y1, plot, kFirst, kLast);
+    }
+};
+
+template <bool Steep, int YStep>
+struct Bresenham {
+    template <class Plot>
+    static void run(int x0, int y0, int x1, int y1, Plot& plot, int kFirst, int kLast) {
+        bresenhamKernel<Steep, YStep>(x0, y0, x1, y1, plot, kFirst, kLast);
+    }
+};
+
+struct NoClip {
+    int x0, y0, x1, y1;
+};
+
+} // namespace line_detail
+
+// === Dispatch, once per line ===
+template <class Plot>
+void drawWuLine(float x0, float y0, float x1, float y1, Plot&& plot) {
+    bool steep = std::fabs(y1 - y0) > std::fabs(x1 - x0);
+    if (steep) { std::swap(x0, y0); std::swap(x1, y1); }
+    if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+    if (steep) line_detail::wuKernel<true>(x0, y0, x1, y1, plot);
+    else line_detail::wuKernel<false>(x0, y0, x1, y1, plot);
+}
+
+// Integer endpoints, no floating point anywhere; within one step of 8-bit
+// coverage of drawWuLine() on the same endpoints
+template <class Plot>
+void drawWuLineFixed(int x0, int y0, int x1, int y1, Plot&& plot) {
+    using namespace line_detail;
+    dispatchInteger<WuFixed>(x0, y0, x1, y1, plot, (const NoClip*)nullptr);
+}
+
+// Same, skipping the steps whose major coordinate falls outside 'clip'
+// (x0, y0, x1, y1, half-open). Pixels outside it along the minor axis
+// still reach plot, so the policy must check them; a line drawn clipped
+// to each of several rectangles gives exactly the pixels of the whole line.
+template <class Plot, class Rect>
+void drawWuLineFixed(int x0, int y0, int x1, int y1, Plot&& plot, const Rect& clip) {
+    line_detail::dispatchInteger<line_detail::WuFixed>(x0, y0, x1, y1, plot, &clip);
+}
+
+// Aliased line, one pixel per major step, plot(x, y, Coverage8{ 255 })
+template <class Plot>
+void drawBresenhamLine(int x0, int y0, int x1, int y1, Plot&& plot) {
+    using namespace line_detail;
+    dispatchInteger<Bresenham>(x0, y0, x1, y1, plot, (const NoClip*)nullptr);
+}
+
+template <class Plot, class Rect>
+void drawBresenhamLine(int x0, int y0, int x1, int y1, Plot&& plot, const Rect& clip) {
+    line_detail::dispatchInteger<line_detail::Bresenham>(x0, y0, x1, y1, plot, &clip);
+}
+
+template <class Plot>
+void drawGuptaSproullLine(int x0, int y0, int x1, int y1, Plot&& plot, float lineWidth = 1.0f) {
+    using namespace line_detail;
+    int dx = std::abs(x1 - x0), dy = std::abs(y1 - y0);
+    int sx = x1 >= x0 ? 1 : -1, sy = y1 >= y0 ? 1 : -1;
+    bool steep = dy > dx;
+    if (steep) {
+        std::swap(x0, y0); std::swap(x1, y1);
+        std::swap(dx, dy); std::swap(sx, sy);
+    }
+    switch ((steep ? 4 : 0) | (sx > 0 ? 2 : 0) | (sy > 0 ? 1 : 0)) {
+      case 0: guptaSproullKernel<false, -1, -1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+      case 1: guptaSproullKernel<false, -1,  1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+      case 2: guptaSproullKernel<false,  1, -1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+      case 3: guptaSproullKernel<false,  1,  1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+      case 4: guptaSproullKernel<true,  -1, -1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+      case 5: guptaSproullKernel<true,  -1,  1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+      case 6: guptaSproullKernel<true,   1, -1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+      case 7: guptaSproullKernel<true,   1,  1>(x0, y0, x1, y1, dx, dy, lineWidth, plot); break;
+    }
+}
@@ -0,0 +1,266 @@
+// poly_clip.h
+// Sutherland-Hodgman polygon clipping on the CPU, for batches of polygons
+// stored as structure-of-arrays (x[], y[] and optional attribute channels
+// that are interpolated along with the position).
+//
+// Clip regions are convex: an axis-aligned rectangle (the viewport) or any
+// convex polygon, both turned into half-planes a*x + b*y + c >= 0. A first
+// SSE pass over all vertices of the batch computes an outcode per vertex,
+// one bit per plane, 4 vertices per step. Polygons with every vertex
+// inside are copied unchanged, polygons entirely outside one plane are
+// dropped, and only the rest are clipped plane by plane, with the signed
+// distances again computed 4 vertices at a time.
+//
+//   PolygonClipper clipper;
+//   clipper.setRect(-20, 20, -20, 20);
+//   ClipBatch in, out;
+//   in.addPolygon(xs, ys, n);            // as many as needed
+//   clipper.clip(in, out);
+//   for (size_t p = 0; p < out.polygonCount(); ++p) draw(out, p);
+//
+// The clipper keeps its scratch buffers, so clipping allocates only while
+// they grow.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const int CLIP_MAX_PLANES     = 32;   // one outcode bit per plane
+const int CLIP_MAX_ATTRIBUTES = 16;   // interpolated channels per vertex
+
+// Inside when a*x + b*y + c >= 0
+struct ClipPlane {
+    float a, b, c;
+};
+
+// === Polygon batch (SoA) ===
+class ClipBatch {
+public:
+    std::vector<float> x, y;
+    std::vector<std::vector<float>> attr;          // attr[k][vertex], up to CLIP_MAX_ATTRIBUTES
+    std::vector<uint32_t> firstVertex, vertexCount;
+
+    explicit ClipBatch(int attributes = 0) : attr(attributes) {}
+
+    int attributeCount() const { return (int)attr.size(); }
+    size_t polygonCount() const { return firstVertex.size(); }
+    size_t vertexTotal() const { return x.size(); }
+
+    // Keeps capacity
+    void clear() {
+        x.clear(); y.clear();
+        for (std::vector<float>& a : attr) a.clear();
+        firstVertex.clear(); vertexCount.clear();
+    }
+
+    // Build a polygon vertex by vertex; 'attrs' holds attributeCount() values
+    void beginPolygon() { firstVertex.push_back((uint32_t)x.size()); }
+    void vertex(float vx, float vy, const float* attrs = nullptr) {
+        x.push_back(vx); y.push_back(vy);
+        for (size_t k = 0; k < attr.size(); ++k) attr[k].push_back(attrs ? attrs[k] : 0.0f);
+    }
+    // Fewer than 3 vertices leave no polygon
+    void endPolygon() {
+        uint32_t n = (uint32_t)x.size() - firstVertex.back();
+        if (n >= 3) { vertexCount.push_back(n); return; }
+        resizeVertices(firstVertex.back());
+        firstVertex.pop_back();
+    }
+
+    void addPolygon(const float* xs, const float* ys, int n) {
+        beginPolygon();
+        for (int i = 0; i < n; ++i) vertex(xs[i], ys[i]);
+        endPolygon();
+    }
+
+    void resizeVertices(size_t n) {
+        x.resize(n); y.resize(n);
+        for (std::vector<float>& a : attr) a.resize(n);
+    }
+};
+
+namespace clip_detail {
+
+// d[i] = a*x[i] + b*y[i] + c for i in [0,n)
+inline void planeDistances(const ClipPlane& p, const float* x, const float* y, size_t n, float* d) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 a = _mm_set1_ps(p.a), b = _mm_set1_ps(p.b), c = _mm_set1_ps(p.c);
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(x + i)), _mm_mul_ps(b, _mm_loadu_ps(y + i))), c);
+        _mm_storeu_ps(d + i, v);
+    }
+#endif
+    for (; i < n; ++i) d[i] = p.a * x[i] + p.b * y[i] + p.c;
+}
+
+// codes[i] |= bit for every vertex outside 'p'
+inline void planeOutcodes(const ClipPlane& p, uint32_t bit, const float* x, const float* y, size_t n,
+                          uint32_t* codes) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 a = _mm_set1_ps(p.a), b = _mm_set1_ps(p.b), c = _mm_set1_ps(p.c);
+    const __m128i bits = _mm_set1_epi32((int)bit);
+    for (; i + 4 <= n; i += 4) {
+        __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, _mm_loadu_ps(x + i)), _mm_mul_ps(b, _mm_loadu_ps(y + i))), c);
+        __m128i out = _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(d, _mm_setzero_ps())), bits);
+        __m128i* dst = reinterpret_cast<__m128i*>(codes + i);
+        _mm_storeu_si128(dst, _mm_or_si128(_mm_loadu_si128(dst), out));
+    }
+#endif
+    for (; i < n; ++i)
+        if (p.a * x[i] + p.b * y[i] + p.c < 0) codes[i] |= bit;
+}
+
+} // namespace clip_detail
+
+// === Clipper ===
+class PolygonClipper {
+public:
+    // Viewport rectangle
+    void setRect(float xmin, float xmax, float ymin, float ymax) {
+        planes.assign({ { 1, 0, -xmin }, { -1, 0, xmax }, { 0, 1, -ymin }, { 0, -1, ymax } });
+    }
+
+    // Convex clip polygon, either winding. Returns false (and keeps the
+    // previous region) if it is degenerate, not convex, or has more than
+    // CLIP_MAX_PLANES edges.
+    bool setConvex(const float* x, const float* y, int n) {
+        if (n < 3 || n > CLIP_MAX_PLANES) return false;
+        double area = 0;
+        for (int i = 0, j = n - 1; i < n; j = i++) area += (double)x[j] * y[i] - (double)x[i] * y[j];
+        if (area == 0) return false;
+        float sign = area > 0 ? 1.0f : -1.0f;    // counter-clockwise: inside is left of each edge
+        std::vector<ClipPlane> edges;
+        for (int i = 0; i < n; ++i) {
+            int j = (i + 1) % n, k = (i + 2) % n;
+            double turn = (double)(x[j] - x[i]) * (y[k] - y[j]) - (double)(y[j] - y[i]) * (x[k] - x[j]);
+            if (turn * sign < 0) return false;
+            float a = -(y[j] - y[i]) * sign, b = (x[j] - x[i]) * sign;
+            if (a == 0 && b == 0) continue;        // repeated vertex
+            edges.push_back({ a, b, -(a * x[i] + b * y[i]) });
+        }
+        planes.swap(edges);
+        return true;
+    }
+
+    int planeCount() const { return (int)planes.size(); }
+
+    // Clip every polygon of 'in' into 'out' (cleared first; it gets the
+    // same attribute channels). Polygon order is kept; polygons clipped
+    // away disappear.
+    void clip(const ClipBatch& in, ClipBatch& out) {
+        using namespace clip_detail;
+        out.attr.resize(in.attr.size());
+        out.clear();
+        size_t n = in.vertexTotal();
+        codes.assign(n, 0);
+        for (size_t p = 0; p < planes.size(); ++p)
+            planeOutcodes(planes[p], 1u << p, in.x.data(), in.y.data(), n, codes.data());
+
+        for (size_t poly = 0; poly < in.polygonCount(); ++poly) {
+            uint32_t first = in.firstVertex[poly], count = in.vertexCount[poly];
+            uint32_t all = ~0u, any = 0;
+            for (uint32_t i = first; i < first + count; ++i) { all &= codes[i]; any |= codes[i]; }
+            if (all) continue;                                // outside one plane: gone
+            if (!any) { copyPolygon(in, first, count, out); continue; }
+            clipPolygon(in, first, count, any, out);
+        }
+    }
+
+private:
+    // Ping-pong vertex buffers for one polygon
+    struct Buffer {
+        std::vector<float> x, y;
+        std::vector<std::vector<float>> attr;
+        size_t size = 0;
+        // Channels added since the last batch get the positions' capacity,
+        // which push() relies on
+        void reset(int attributes) {
+            attr.resize(attributes);
+            for (std::vector<float>& c : attr) c.resize(x.size());
+            size = 0;
+        }
+        void push(float vx, float vy, const float* a, int attributes) {
+            if (size == x.size()) {
+                size_t cap = std::max<size_t>(16, x.size() * 2);
+                x.resize(cap); y.resize(cap);
+                for (std::vector<float>& c : attr) c.resize(cap);
+            }
+            x[size] = vx; y[size] = vy;
+            for (int k = 0; k < attributes; ++k) attr[k][size] = a[k];
+            ++size;
+        }
+    };
+
+    static void copyPolygon(const ClipBatch& in, uint32_t first, uint32_t count, ClipBatch& out) {
+        out.firstVertex.push_back((uint32_t)out.x.size());
+        out.vertexCount.push_back(count);
+        out.x.insert(out.x.end(), in.x.begin() + first, in.x.begin() + first + count);
+        out.y.insert(out.y.end(), in.y.begin() + first, in.y.begin() + first + count);
+        for (size_t k = 0; k < in.attr.size(); ++k)
+            out.attr[k].insert(out.attr[k].end(), in.attr[k].begin() + first, in.attr[k].begin() + first + count);
+    }
+
+    // Sutherland-Hodgman against the planes in 'mask' only (the others
+    // have every vertex inside)
+    void clipPolygon(const ClipBatch& in, uint32_t first, uint32_t count, uint32_t mask, ClipBatch& out) {
+        const int attributes = in.attributeCount();
+        Buffer* src = &ping;
+        Buffer* dst = &pong;
+        src->reset(attributes);
+        dst->reset(attributes);
+        float a[CLIP_MAX_ATTRIBUTES], b[CLIP_MAX_ATTRIBUTES], mid[CLIP_MAX_ATTRIBUTES];
+        for (uint32_t i = first; i < first + count; ++i) {
+            for (int k = 0; k < attributes; ++k) a[k] = in.attr[k][i];
+            src->push(in.x[i], in.y[i], a, attributes);
+        }
+
+        for (size_t p = 0; p < planes.size() && src->size >= 3; ++p) {
+            if (!(mask & (1u << p))) continue;
+            const ClipPlane& plane = planes[p];
+            size_t n = src->size;
+            dist.resize(std::max(dist.size(), n));
+            clip_detail::planeDistances(plane, src->x.data(), src->y.data(), n, dist.data());
+            dst->reset(attributes);
+            for (size_t i = 0; i < n; ++i) {
+                size_t j = i + 1 == n ? 0 : i + 1;
+                float di = dist[i], dj = dist[j];
+                for (int k = 0; k < attributes; ++k) a[k] = src->attr[k][i];
+                if (di >= 0) dst->push(src->x[i], src->y[i], a, attributes);
+                if ((di >= 0) == (dj >= 0)) continue;
+                // Edge crosses the plane: add the crossing point
+                float t = di / (di - dj);
+                for (int k = 0; k < attributes; ++k) {
+                    b[k] = src->attr[k][j];
+                    mid[k] = a[k] + t * (b[k] - a[k]);
+                }
+                float x = src->x[i] + t * (src->x[j] - src->x[i]);
+                float y = src->y[i] + t * (src->y[j] - src->y[i]);
+                if (plane.b == 0) x = -plane.c / plane.a;     // land exactly on rectangle edges
+                if (plane.a == 0) y = -plane.c / plane.b;
+                dst->push(x, y, mid, attributes);
+            }
+            std::swap(src, dst);
+        }
+        if (src->size < 3) return;
+
+        out.firstVertex.push_back((uint32_t)out.x.size());
+        out.vertexCount.push_back((uint32_t)src->size);
+        out.x.insert(out.x.end(), src->x.begin(), src->x.begin() + src->size);
+        out.y.insert(out.y.end(), src->y.begin(), src->y.begin() + src->size);
+        for (int k = 0; k < attributes; ++k)
+            out.attr[k].insert(out.attr[k].end(), src->attr[k].begin(), src->attr[k].begin() + src->size);
+    }
+
+    std::vector<ClipPlane> planes;
+    std::vector<uint32_t> codes;
+    std::vector<float> dist;
+    Buffer ping, pong;
+};
@@ -0,0 +1,181 @@
+// run_canvas.h
+// Run-length encoded character canvas: each row is a sorted list of runs
+// [x0, x1) of one symbol, and background is simply where no run is. Line
+// art is mostly background, so a canvas costs memory and file size in
+// proportion to what is drawn, not to its area. Span rasterizers write
+// runs directly; single cells are one-cell runs that merge with their
+// neighbours.
+//
+//   RunCanvas canvas(w, h, '.');
+//   canvas.fillSpan(y, x0, x1, '#');       // later runs overwrite earlier ones
+//   canvas.save(out);                      // text: header, then one line per non-empty row
+//   canvas.load(in);
+//   canvas.decodeRow(y, chars);            // dense, w chars
+//
+// File format ("RLE1"), whitespace separated:
+//   RLE1 <width> <height> <background>
+//   <y> <runs> { <x0> <length> <symbol> }     one line per non-empty row
+// Row 0 is the bottom row, as on the character canvases. Symbols are
+// printable non-space chars.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bit_canvas.h"
+
+struct CellRun {
+    int x0, x1;      // [x0, x1)
+    char symbol;
+};
+
+class RunCanvas {
+public:
+    RunCanvas(int w = 0, int h = 0, char background = '.') { resize(w, h, background); }
+
+    void resize(int w, int h, char background = '.') {
+        width_ = w; height_ = h; bg = background;
+        rows.assign(h, std::vector<CellRun>());
+    }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    char background() const { return bg; }
+
+    void clear() {
+        for (auto& r : rows) r.clear();
+    }
+
+    void set(int x, int y, char symbol) { fillSpan(y, x, x + 1, symbol); }
+
+    // Paint [x0, x1) of row y (clipped), replacing what is there, and merge
+    // with neighbouring runs of the same symbol
+    void fillSpan(int y, int x0, int x1, char symbol) {
+        if (y < 0 || y >= height_) return;
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, width_);
+        if (x0 >= x1) return;
+        std::vector<CellRun>& row = rows[y];
+
+        // Runs touching [x0 - 1, x1 + 1): candidates for trimming or merging
+        auto first = std::lower_bound(row.begin(), row.end(), x0,
+                                      [](const CellRun& r, int x) { return r.x1 < x; });
+        auto last = first;
+        while (last != row.end() && last->x0 <= x1) ++last;
+
+        CellRun run = { x0, x1, symbol };
+        CellRun left = { 0, 0, 0 }, right = { 0, 0, 0 };
+        bool keepLeft = false, keepRight = false;
+        if (first != last) {
+            const CellRun& a = *first;
+            if (a.x0 < x0) {
+                if (a.symbol == symbol) run.x0 = a.x0;
+                else { left = { a.x0, x0, a.symbol }; keepLeft = true; }
+            }
+            const CellRun& b = *(last - 1);
+            if (b.x1 > x1) {
+                if (b.symbol == symbol) run.x1 = b.x1;
+                else { right = { x1, b.x1, b.symbol }; keepRight = true; }
+            }
+        }
+
+        // Replace [first, last) with left? run right?
+        size_t at = first - row.begin(), removed = last - first;
+        size_t added = 1 + keepLeft + keepRight;
+        if (added > removed) row.insert(row.begin() + at, added - removed, CellRun());
+        else row.erase(row.begin() + at, row.begin() + at + (removed - added));
+        size_t i = at;
+        if (keepLeft) row[i++] = left;
+        row[i++] = run;
+        if (keepRight) row[i] = right;
+    }
+
+    // Symbol at (x, y), the background where nothing is drawn
+    char at(int x, int y) const {
+        if (y < 0 || y >= height_) return bg;
+        const std::vector<CellRun>& row = rows[y];
+        auto it = std::upper_bound(row.begin(), row.end(), x, [](int v, const CellRun& r) { return v < r.x1; });
+        return it != row.end() && it->x0 <= x ? it->symbol : bg;
+    }
+
+    const std::vector<CellRun>& row(int y) const { return rows[y]; }
+
+    // Cells drawn on, and the runs holding them
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (auto& r : rows)
+            for (const CellRun& c : r) n += c.x1 - c.x0;
+        return n;
+    }
+    size_t runCount() const {
+        size_t n = 0;
+        for (auto& r : rows) n += r.size();
+        return n;
+    }
+
+    bool boundingBox(BitRect& box) const {
+        box = { width_, height_, 0, 0 };
+        for (int y = 0; y < height_; ++y) {
+            if (rows[y].empty()) continue;
+            box = { std::min(box.x0, rows[y].front().x0), std::min(box.y0, y),
+                    std::max(box.x1, rows[y].back().x1), y + 1 };
+        }
+        return box.x0 < box.x1;
+    }
+
+    // === Decoding to dense formats ===
+    // Row y as width() chars
+    void decodeRow(int y, char* out) const {
+        std::fill(out, out + width_, bg);
+        for (const CellRun& r : rows[y]) std::fill(out + r.x0, out + r.x1, r.symbol);
+    }
+
+    // Into a bit mask (same size): every drawn cell set
+    void decode(BitCanvas& mask) const {
+        mask.resize(width_, height_);
+        for (int y = 0; y < height_; ++y)
+            for (const CellRun& r : rows[y]) mask.fillSpan(y, r.x0, r.x1);
+    }
+
+    // === Files ===
+    void save(std::ostream& out) const {
+        out << "RLE1 " << width_ << ' ' << height_ << ' ' << bg << '\n';
+        for (int y = 0; y < height_; ++y) {
+            if (rows[y].empty()) continue;
+            out << y << ' ' << rows[y].size();
+            for (const CellRun& r : rows[y]) out << ' ' << r.x0 << ' ' << r.x1 - r.x0 << ' ' << r.symbol;
+            out << '\n';
+        }
+        if (!out) throw std::runtime_error("RLE write failed");
+    }
+
+    void load(std::istream& in) {
+        std::string magic;
+        int w, h;
+        char background;
+        if (!(in >> magic >> w >> h >> background) || magic != "RLE1" || w < 0 || h < 0)
+            throw std::runtime_error("Not an RLE1 canvas");
+        resize(w, h, background);
+        int y;
+        size_t n;
+        while (in >> y >> n) {
+            if (y < 0 || y >= h) throw std::runtime_error("RLE row out of range");
+            for (size_t i = 0; i < n; ++i) {
+                int x0, length;
+                char symbol;
+                if (!(in >> x0 >> length >> symbol)) throw std::runtime_error("Truncated RLE row");
+                fillSpan(y, x0, x0 + length, symbol);
+            }
+        }
+        if (!in.eof()) throw std::runtime_error("Malformed RLE canvas");
+    }
+
+private:
+    int width_ = 0, height_ = 0;
+    char bg = '.';
+    std::vector<std::vector<CellRun>> rows;
+};
@@ -0,0 +1,324 @@
+// scene_binary.h
+// Binary scene files: typed arrays of lines, circles, ellipses, polygons
+// and labels, memory-mapped and used in place (no parsing, no copies).
+// Arrays start on 64-byte boundaries and their element layouts are the
+// ones the renderers consume, so GL can read vertex arrays straight out of
+// the mapping and circles upload as CircleInstance records.
+// Opening a file checks the header, the section bounds and the polygon
+// ranges; nothing else is read, so the load time grows only with the
+// polygon count.
+// Linux/POSIX only (mmap). SceneBuilder writes files; scene_stream.h
+// parses the text form into builders.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// === File layout ===
+// [SceneHeader][section 0][section 1]... each section 64-byte aligned.
+const uint32_t SCENE_MAGIC   = 0x314E4353; // "SCN1"
+const uint32_t SCENE_VERSION = 1;
+
+// Interleaved vertex: position plus RGBA8 color (packRGBA() order), so it
+// feeds glVertexPointer/glColorPointer with a 12-byte stride
+struct SceneVertex {
+    float x, y;
+    uint32_t color;
+};
+
+// Same layout as CircleInstance (instanced_circles.h)
+struct SceneCircle {
+    float cx, cy, radius;
+    float texOffsetU, texOffsetV;
+    uint32_t color;
+};
+
+struct SceneEllipse {
+    float cx, cy, rx, ry;
+    uint32_t color;
+};
+
+struct SceneLabel {
+    float x, y;
+    uint32_t textOffset, textLength;   // into the LabelText section
+    uint32_t color;
+};
+
+enum SceneSectionId {
+    SceneLineVertices,     // SceneVertex, two per line (GL_LINES order)
+    SceneCircles,          // SceneCircle
+    SceneEllipses,         // SceneEllipse
+    ScenePolygonFirst,     // int32 first vertex of each polygon
+    ScenePolygonCount,     // int32 vertex count of each polygon
+    ScenePolygonVertices,  // SceneVertex, all polygons back to back
+    SceneLabels,           // SceneLabel
+    SceneLabelText,        // char, not terminated
+    SCENE_SECTION_COUNT
+};
+
+struct SceneSection {
+    uint64_t offset;       // from the start of the file
+    uint64_t count;        // elements
+    uint32_t elementSize;  // checked on open against this build's structs
+    uint32_t reserved;
+};
+
+struct SceneHeader {
+    uint32_t magic;
+    uint32_t version;
+    float view[4];         // world window: left, right, bottom, top
+    uint64_t totalSize;
+    SceneSection sections[SCENE_SECTION_COUNT];
+};
+
+inline uint32_t sceneElementSize(int section) {
+    static const uint32_t sizes[SCENE_SECTION_COUNT] = {
+        sizeof(SceneVertex), sizeof(SceneCircle), sizeof(SceneEllipse), sizeof(int32_t),
+        sizeof(int32_t), sizeof(SceneVertex), sizeof(SceneLabel), sizeof(char)
+    };
+    return sizes[section];
+}
+
+// Contiguous read-only array inside the mapping
+template <class T>
+struct SceneArray {
+    const T* data;
+    size_t size;
+    const T* begin() const { return data; }
+    const T* end() const { return data + size; }
+    const T& operator[](size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+// === MappedScene ===
+// Owns the mapping and unmaps on destruction.
+class MappedScene {
+    void*  base = nullptr;
+    size_t size = 0;
+
+public:
+    MappedScene() = default;
+    MappedScene(const MappedScene&) = delete;
+    MappedScene& operator=(const MappedScene&) = delete;
+    ~MappedScene() { release(); }
+
+    // Map 'path' and check the header, then that every polygon range lies
+    // inside the vertex array (one pass over the polygon tables), since
+    // renderers hand those ranges to GL unchecked. Pass checkPolygons =
+    // false only for files this program just wrote with SceneBuilder.
+    bool open(const std::string& path, std::string& err, bool checkPolygons = true) {
+        release();
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) { err = "cannot open " + path; return false; }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SceneHeader)) {
+            close(fd);
+            err = path + ": not a scene file";
+            return false;
+        }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) { err = "cannot map " + path; return false; }
+        base = p; size = st.st_size;
+
+        const SceneHeader& h = header();
+        if (h.magic != SCENE_MAGIC || h.version != SCENE_VERSION || h.totalSize != size) {
+            release();
+            err = path + ": not a scene file (or truncated)";
+            return false;
+        }
+        for (int s = 0; s < SCENE_SECTION_COUNT; ++s) {
+            const SceneSection& sec = h.sections[s];
+            if (sec.elementSize != sceneElementSize(s) || sec.offset % 64 != 0 ||
+                sec.offset > size || sec.count > (size - sec.offset) / sec.elementSize) {
+                release();
+                err = path + ": corrupt section table";
+                return false;
+            }
+        }
+        if (polygonFirst().size != polygonCount().size) {
+            release();
+            err = path + ": polygon tables differ in length";
+            return false;
+        }
+        if (checkPolygons) {
+            size_t nv = polygonVertices().size;
+            for (size_t i = 0; i < polygonFirst().size; ++i) {
+                int64_t first = polygonFirst()[i], count = polygonCount()[i];
+                if (first < 0 || count < 0 || (uint64_t)(first + count) > nv) {
+                    release();
+                    err = path + ": polygon out of range";
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void release() {
+        if (base) munmap(base, size);
+        base = nullptr; size = 0;
+    }
+
+    bool valid() const { return base != nullptr; }
+    const SceneHeader& header() const { return *static_cast<const SceneHeader*>(base); }
+    const float* view() const { return header().view; }
+
+    template <class T>
+    SceneArray<T> section(int s) const {
+        const SceneSection& sec = header().sections[s];
+        return { reinterpret_cast<const T*>(static_cast<const char*>(base) + sec.offset), (size_t)sec.count };
+    }
+    SceneArray<SceneVertex>  lineVertices() const    { return section<SceneVertex>(SceneLineVertices); }
+    SceneArray<SceneCircle>  circles() const         { return section<SceneCircle>(SceneCircles); }
+    SceneArray<SceneEllipse> ellipses() const        { return section<SceneEllipse>(SceneEllipses); }
+    SceneArray<int32_t>      polygonFirst() const    { return section<int32_t>(ScenePolygonFirst); }
+    SceneArray<int32_t>      polygonCount() const    { return section<int32_t>(ScenePolygonCount); }
+    SceneArray<SceneVertex>  polygonVertices() const { return section<SceneVertex>(ScenePolygonVertices); }
+    SceneArray<SceneLabel>   labels() const          { return section<SceneLabel>(SceneLabels); }
+    // Label characters (not terminated); empty if the range is out of bounds
+    std::string labelText(const SceneLabel& l) const {
+        SceneArray<char> text = section<char>(SceneLabelText);
+        if ((uint64_t)l.textOffset + l.textLength > text.size) return std::string();
+        return std::string(text.data + l.textOffset, l.textLength);
+    }
+};
+
+// === SceneBuilder ===
+// Collects primitives in memory and writes a scene file.
+struct SceneBuilder {
+    std::vector<SceneVertex>  lineVertices;
+    std::vector<SceneCircle>  circles;
+    std::vector<SceneEllipse> ellipses;
+    std::vector<int32_t>      polygonFirst, polygonCount;
+    std::vector<SceneVertex>  polygonVertices;
+    std::vector<SceneLabel>   labels;
+    std::string               labelText;
+    float view[4] = { 0, 0, 0, 0 };
+    bool  hasView = false;
+
+    void line(float x0, float y0, float x1, float y1, uint32_t color) {
+        lineVertices.push_back({ x0, y0, color });
+        lineVertices.push_back({ x1, y1, color });
+    }
+    void circle(float cx, float cy, float r, uint32_t color) {
+        circles.push_back({ cx, cy, r, 0.0f, 0.0f, color });
+    }
+    void ellipse(float cx, float cy, float rx, float ry, uint32_t color) {
+        ellipses.push_back({ cx, cy, rx, ry, color });
+    }
+    // 'xy' holds n (x, y) pairs
+    void polygon(const float* xy, int n, uint32_t color) {
+        polygonFirst.push_back((int32_t)polygonVertices.size());
+        polygonCount.push_back(n);
+        for (int i = 0; i < n; ++i) polygonVertices.push_back({ xy[2 * i], xy[2 * i + 1], color });
+    }
+    void label(float x, float y, const std::string& text, uint32_t color) {
+        labels.push_back({ x, y, (uint32_t)labelText.size(), (uint32_t)text.size(), color });
+        labelText += text;
+    }
+
+    size_t primitiveCount() const {
+        return lineVertices.size() / 2 + circles.size() + ellipses.size() + polygonFirst.size() + labels.size();
+    }
+
+    // Empty the arrays but keep their capacity, for reuse as a batch
+    void clear() {
+        lineVertices.clear(); circles.clear(); ellipses.clear();
+        polygonFirst.clear(); polygonCount.clear(); polygonVertices.clear();
+        labels.clear(); labelText.clear();
+        hasView = false;
+    }
+
+    // Add everything in 'b' (offsets rebased); its view wins if it has one
+    void append(const SceneBuilder& b) {
+        lineVertices.insert(lineVertices.end(), b.lineVertices.begin(), b.lineVertices.end());
+        circles.insert(circles.end(), b.circles.begin(), b.circles.end());
+        ellipses.insert(ellipses.end(), b.ellipses.begin(), b.ellipses.end());
+        int32_t base = (int32_t)polygonVertices.size();
+        for (int32_t f : b.polygonFirst) polygonFirst.push_back(base + f);
+        polygonCount.insert(polygonCount.end(), b.polygonCount.begin(), b.polygonCount.end());
+        polygonVertices.insert(polygonVertices.end(), b.polygonVertices.begin(), b.polygonVertices.end());
+        for (SceneLabel l : b.labels) {
+            l.textOffset += (uint32_t)labelText.size();
+            labels.push_back(l);
+        }
+        labelText += b.labelText;
+        if (b.hasView) { std::memcpy(view, b.view, sizeof(view)); hasView = true; }
+    }
+
+    // Bounding box of everything, with a 5% margin; used when no view was given
+    void fitView() {
+        float lo[2] = { 1e30f, 1e30f }, hi[2] = { -1e30f, -1e30f };
+        auto grow = [&](float x, float y, float rx, float ry) {
+            lo[0] = std::min(lo[0], x - rx); hi[0] = std::max(hi[0], x + rx);
+            lo[1] = std::min(lo[1], y - ry); hi[1] = std::max(hi[1], y + ry);
+        };
+        for (const SceneVertex& v : lineVertices)    grow(v.x, v.y, 0, 0);
+        for (const SceneVertex& v : polygonVertices) grow(v.x, v.y, 0, 0);
+        for (const SceneCircle& c : circles)         grow(c.cx, c.cy, c.radius, c.radius);
+        for (const SceneEllipse& e : ellipses)       grow(e.cx, e.cy, e.rx, e.ry);
+        for (const SceneLabel& l : labels)           grow(l.x, l.y, 0, 0);
+        if (lo[0] > hi[0]) { lo[0] = lo[1] = -1; hi[0] = hi[1] = 1; }
+        float mx = std::max(1e-3f, (hi[0] - lo[0]) * 0.05f), my = std::max(1e-3f, (hi[1] - lo[1]) * 0.05f);
+        view[0] = lo[0] - mx; view[1] = hi[0] + mx;
+        view[2] = lo[1] - my; view[3] = hi[1] + my;
+    }
+
+    // Written under a temporary name and renamed, like the texture cache
+    bool write(const std::string& path, std::string& err) {
+        if (!hasView) fitView();
+        SceneHeader h;
+        std::memset(&h, 0, sizeof(h));
+        h.magic = SCENE_MAGIC;
+        h.version = SCENE_VERSION;
+        std::memcpy(h.view, view, sizeof(view));
+
+        const void* data[SCENE_SECTION_COUNT] = {
+            lineVertices.data(), circles.data(), ellipses.data(), polygonFirst.data(),
+            polygonCount.data(), polygonVertices.data(), labels.data(), labelText.data()
+        };
+        const size_t counts[SCENE_SECTION_COUNT] = {
+            lineVertices.size(), circles.size(), ellipses.size(), polygonFirst.size(),
+            polygonCount.size(), polygonVertices.size(), labels.size(), labelText.size()
+        };
+        uint64_t offset = sizeof(SceneHeader);
+        for (int s = 0; s < SCENE_SECTION_COUNT; ++s) {
+            offset = (offset + 63) & ~(uint64_t)63;
+            h.sections[s] = { offset, counts[s], sceneElementSize(s), 0 };
+            offset += counts[s] * sceneElementSize(s);
+        }
+        h.totalSize = (offset + 63) & ~(uint64_t)63;
+
+        std::string tmp = path + ".tmp";
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) { err = "cannot write " + tmp; return false; }
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        static const char zeros[64] = {};
+        uint64_t pos = sizeof(h);
+        for (int s = 0; s < SCENE_SECTION_COUNT; ++s) {
+            out.write(zeros, h.sections[s].offset - pos);
+            uint64_t bytes = counts[s] * sceneElementSize(s);
+            out.write(static_cast<const char*>(data[s]), bytes);
+            pos = h.sections[s].offset + bytes;
+        }
+        out.write(zeros, h.totalSize - pos);
+        out.close();
+        if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) {
+            std::remove(tmp.c_str());
+            err = "cannot write " + path;
+            return false;
+        }
+        return true;
+    }
+};
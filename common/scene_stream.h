@@ -0,0 +1,297 @@
+// scene_stream.h
+// Streaming parser for text scenes. The file is read in large chunks with
+// read(); lines are split and tokenized as std::string_view slices of the
+// chunk buffer and numbers converted with std::from_chars, so parsing
+// allocates nothing per line or token. Primitives are collected into
+// batches (SceneBuilder, scene_binary.h) that a consumer rasterizes on the
+// calling thread while a worker thread parses the next ones; batches are
+// recycled through a small pool, so steady-state parsing allocates nothing.
+//
+// Text form: one primitive per line; '#' starts a comment. Colors are
+// floats in [0,1] and apply to everything after them.
+//   view l r b t                 world window (default: fit the contents)
+//   color r g b [a]
+//   line x0 y0 x1 y1
+//   circle cx cy r
+//   ellipse cx cy rx ry
+//   poly n x0 y0 ... xn-1 yn-1
+//   label x y text to end of line
+
+#pragma once
+
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "scene_binary.h"
+
+const size_t SCENE_STREAM_CHUNK = 1 << 20;   // bytes per read()
+const size_t SCENE_STREAM_BATCH = 4096;      // primitives per batch
+const int    SCENE_STREAM_DEPTH = 3;         // batches in flight
+
+// packRGBA() without soft_raster.h's GL dependency
+inline uint32_t scenePackColor(float r, float g, float b, float a) {
+    auto c = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    return c(r) | (c(g) << 8) | (c(b) << 16) | (c(a) << 24);
+}
+
+// === Line parser ===
+// Keeps the state that spans lines (current color, line number).
+class SceneTextParser {
+public:
+    // Parse one line (without its '\n') into 'out'
+    bool parseLine(std::string_view line, SceneBuilder& out, std::string& err) {
+        ++lineNo;
+        size_t hash = line.find('#');
+        if (hash != std::string_view::npos) line = line.substr(0, hash);
+        rest = line;
+        std::string_view kind = token();
+        if (kind.empty()) return true;
+
+        bool ok = true;
+        if (kind == "view") {
+            ok = numbers(out.view, 4);
+            out.hasView = ok;
+        } else if (kind == "color") {
+            float c[4] = { 0, 0, 0, 1 };
+            ok = numbers(c, 3);
+            if (ok && !token().empty()) ok = number(lastToken, c[3]);
+            color = scenePackColor(c[0], c[1], c[2], c[3]);
+        } else if (kind == "line") {
+            float v[4];
+            if ((ok = numbers(v, 4))) out.line(v[0], v[1], v[2], v[3], color);
+        } else if (kind == "circle") {
+            float v[3];
+            if ((ok = numbers(v, 3))) out.circle(v[0], v[1], v[2], color);
+        } else if (kind == "ellipse") {
+            float v[4];
+            if ((ok = numbers(v, 4))) out.ellipse(v[0], v[1], v[2], v[3], color);
+        } else if (kind == "poly") {
+            // Each coordinate takes at least a digit and a separator, so a
+            // count the rest of the line cannot hold is rejected before
+            // anything is allocated for it
+            float n = 0;
+            ok = numbers(&n, 1) && n >= 2 && n <= rest.size() / 4 && n == (int)n;
+            if (ok) {
+                xy.resize(2 * (size_t)n);
+                if ((ok = numbers(xy.data(), xy.size()))) out.polygon(xy.data(), (int)n, color);
+            }
+        } else if (kind == "label") {
+            float p[2];
+            if ((ok = numbers(p, 2))) {
+                std::string_view text = rest;
+                while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+                while (!text.empty() && (text.back() == '\r' || text.back() == ' ')) text.remove_suffix(1);
+                out.label(p[0], p[1], std::string(text), color);
+            }
+        } else {
+            err = "line " + std::to_string(lineNo) + ": unknown primitive '" + std::string(kind) + "'";
+            return false;
+        }
+        if (!ok) {
+            err = "line " + std::to_string(lineNo) + ": bad '" + std::string(kind) + "' arguments";
+            return false;
+        }
+        return true;
+    }
+
+    size_t line() const { return lineNo; }
+
+private:
+    std::string_view rest, lastToken;
+    std::vector<float> xy;       // polygon scratch, reused
+    uint32_t color = 0xFFFFFFFF;
+    size_t lineNo = 0;
+
+    static bool space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    std::string_view token() {
+        size_t b = 0;
+        while (b < rest.size() && space(rest[b])) ++b;
+        size_t e = b;
+        while (e < rest.size() && !space(rest[e])) ++e;
+        lastToken = rest.substr(b, e - b);
+        rest.remove_prefix(e);
+        return lastToken;
+    }
+
+    static bool number(std::string_view t, float& v) {
+        if (!t.empty() && t.front() == '+') t.remove_prefix(1);   // from_chars rejects '+'
+        auto r = std::from_chars(t.data(), t.data() + t.size(), v);
+        return r.ec == std::errc() && r.ptr == t.data() + t.size();
+    }
+
+    bool numbers(float* v, size_t n) {
+        for (size_t i = 0; i < n; ++i)
+            if (!number(token(), v[i])) return false;
+        return true;
+    }
+};
+
+// === Streaming driver ===
+struct SceneStreamStats {
+    size_t bytes = 0, batches = 0, primitives = 0;
+    double parseMs = 0;     // parser thread busy time (reading included, waits for a free batch not)
+    double consumeMs = 0;   // time inside the consumer
+    double wallMs = 0;
+};
+
+// Parse 'path' on a worker thread and call 'consume' on this thread for
+// each batch of about 'batchSize' primitives, in file order. A batch is
+// only valid during its callback. Returns false with 'err' on an I/O or
+// syntax error (batches before the error have been consumed). If
+// 'consume' throws, the parser is stopped and joined and the exception
+// passes on.
+inline bool streamSceneFile(const std::string& path,
+                            const std::function<void(const SceneBuilder&)>& consume,
+                            std::string& err, size_t batchSize = SCENE_STREAM_BATCH,
+                            SceneStreamStats* stats = nullptr) {
+    typedef std::chrono::steady_clock clock;
+    auto ms = [](clock::time_point a, clock::time_point b) {
+        return std::chrono::duration<double, std::milli>(b - a).count();
+    };
+    auto wallStart = clock::now();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) { err = "cannot open " + path; return false; }
+
+    // Free batches go parser-ward, full ones consumer-ward; nullptr ends the stream
+    std::vector<std::unique_ptr<SceneBuilder>> pool;
+    std::deque<SceneBuilder*> freeQ, fullQ;
+    for (int i = 0; i < SCENE_STREAM_DEPTH; ++i) {
+        pool.emplace_back(new SceneBuilder);
+        freeQ.push_back(pool.back().get());
+    }
+    std::mutex m;
+    std::condition_variable cv;
+    std::string parseErr;
+    bool stop = false;   // the consumer has left: parser, quit
+    SceneStreamStats s;
+
+    std::thread parser([&] {
+        auto start = clock::now();
+        double waitMs = 0;
+        auto takeFree = [&] {
+            auto t = clock::now();
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return stop || !freeQ.empty(); });
+            waitMs += ms(t, clock::now());
+            if (stop) return (SceneBuilder*)nullptr;
+            SceneBuilder* b = freeQ.front();
+            freeQ.pop_front();
+            return b;
+        };
+        auto publish = [&](SceneBuilder* b) {
+            std::lock_guard<std::mutex> lock(m);
+            fullQ.push_back(b);
+            cv.notify_all();
+        };
+
+        SceneTextParser text;
+        SceneBuilder* batch = nullptr;
+        bool ok = false;
+        try {
+            std::vector<char> buf(SCENE_STREAM_CHUNK);
+            size_t have = 0;                     // bytes carried over from the last chunk
+            batch = takeFree();
+            ok = batch != nullptr;
+            if (batch) batch->clear();
+            bool eof = false;
+            while (ok && !eof) {
+                {
+                    std::lock_guard<std::mutex> lock(m);
+                    if (stop) { ok = false; break; }
+                }
+                if (have == buf.size()) buf.resize(buf.size() * 2);   // one very long line
+                ssize_t n = ::read(fd, buf.data() + have, buf.size() - have);
+                if (n < 0) { parseErr = "read error in " + path; ok = false; break; }
+                eof = n == 0;
+                s.bytes += n;
+                size_t end = have + n, pos = 0;
+                for (;;) {
+                    const char* nl = (const char*)std::memchr(buf.data() + pos, '\n', end - pos);
+                    if (!nl && !eof) break;               // partial line: wait for more data
+                    size_t lineEnd = nl ? nl - buf.data() : end;
+                    if (lineEnd > pos || nl) {
+                        ok = text.parseLine(std::string_view(buf.data() + pos, lineEnd - pos), *batch, parseErr);
+                        if (!ok) break;
+                    }
+                    pos = nl ? lineEnd + 1 : end;
+                    if (batch->primitiveCount() >= batchSize) {
+                        s.primitives += batch->primitiveCount();
+                        ++s.batches;
+                        publish(batch);
+                        batch = takeFree();
+                        if (!batch) { ok = false; break; }
+                        batch->clear();
+                    }
+                    if (pos >= end) break;
+                }
+                have = end - pos;
+                std::memmove(buf.data(), buf.data() + pos, have);
+            }
+        } catch (const std::bad_alloc&) {
+            // A line (or the primitives on it) too large for memory
+            parseErr = "out of memory at line " + std::to_string(text.line());
+            ok = false;
+        }
+        if (ok && (batch->primitiveCount() || batch->hasView)) {
+            s.primitives += batch->primitiveCount();
+            ++s.batches;
+            publish(batch);
+        }
+        s.parseMs = ms(start, clock::now()) - waitMs;
+        ::close(fd);
+        publish(nullptr);
+    });
+    // However this function is left (consume may throw), the parser must
+    // be joined, and told to stop first: it may be waiting for a batch
+    // the consumer will never hand back
+    struct ParserGuard {
+        std::thread& parser;
+        std::mutex& m;
+        std::condition_variable& cv;
+        bool& stop;
+        ~ParserGuard() {
+            if (!parser.joinable()) return;
+            {
+                std::lock_guard<std::mutex> lock(m);
+                stop = true;
+            }
+            cv.notify_all();
+            parser.join();
+        }
+    } guard{ parser, m, cv, stop };
+
+    for (;;) {
+        SceneBuilder* b;
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return !fullQ.empty(); });
+            b = fullQ.front();
+            fullQ.pop_front();
+        }
+        if (!b) break;
+        auto t = clock::now();
+        consume(*b);
+        s.consumeMs += ms(t, clock::now());
+        std::lock_guard<std::mutex> lock(m);
+        freeQ.push_back(b);
+        cv.notify_all();
+    }
+    parser.join();
+    s.wallMs = ms(wallStart, clock::now());
+    if (stats) *stats = s;
+    if (!parseErr.empty()) { err = path + ": " + parseErr; return false; }
+    return true;
+}
@@ -0,0 +1,319 @@
+// sdf_shapes.h
+// Circles and axis-aligned ellipses drawn from their analytic distance
+// instead of a polygon: each shape is one quad (4 vertices whatever the
+// radius), and every pixel inside it computes its signed distance to the
+// outline and turns it into coverage. Coverage ramps over one pixel, so
+// edges come out anti-aliased without multisampling.
+//
+// Ellipse distance uses the gradient estimate f/|grad f| with
+// f = |p/r| - 1, i.e. d = k0 (k0 - 1) / k1, k0 = |p/r|, k1 = |p/r^2|;
+// it is exact for circles and within a fraction of a pixel near the
+// outline of an ellipse, which is all the AA ramp needs.
+//
+// GL path: GLSL 1.20 shader fed from immediate mode, so the current
+// glColor and modelview apply as for any other primitive; drawBatch()
+// puts many shapes in one vertex-array draw. Include after defining
+// GL_GLEXT_PROTOTYPES, before any other GL header.
+// CPU path: SSE2 evaluates 4 pixels of a row per step and blends into a
+// SoftFramebuffer (scalar fallback without SSE2).
+
+#pragma once
+
+#ifndef GL_GLEXT_PROTOTYPES
+#define GL_GLEXT_PROTOTYPES
+#endif
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "soft_raster.h"
+
+struct SdfShape {
+    float cx, cy;       // center, world units
+    float rx, ry;       // radii, world units (rx == ry for a circle)
+    float stroke;       // outline width in pixels; 0 fills the shape
+};
+
+// One shape of a batch, with its own RGBA8 color (packRGBA() order)
+struct SdfInstance {
+    float cx, cy, rx, ry;
+    uint32_t color;
+};
+
+// === GL path ===
+class SdfRenderer {
+public:
+    // Compiles the shader; needs a current context
+    bool init() {
+        const char* vsSrc =
+            "#version 120\n"
+            "varying vec2 local;\n"
+            "varying vec2 radii;\n"
+            "void main() {\n"
+            "    gl_Position = ftransform();\n"
+            "    local = gl_MultiTexCoord0.xy;\n"      // offset from the center, world units
+            "    radii = gl_MultiTexCoord1.xy;\n"      // per vertex so batches need no uniforms
+            "    gl_FrontColor = gl_Color;\n"
+            "}\n";
+        const char* fsSrc =
+            "#version 120\n"
+            "uniform float stroke;\n"
+            "uniform bool textured;\n"
+            "uniform sampler2D tex;\n"
+            "varying vec2 local;\n"
+            "varying vec2 radii;\n"
+            "void main() {\n"
+            "    vec2 a = local / radii, b = a / radii;\n"
+            "    float k0 = length(a), k1 = length(b);\n"
+            "    float d = k1 > 0.0 ? k0 * (k0 - 1.0) / k1 : -min(radii.x, radii.y);\n"
+            // World distance to pixels along the gradient, so anisotropic views work
+            "    float px = length(vec2(dFdx(d), dFdy(d)));\n"
+            "    d /= max(px, 1e-6);\n"
+            "    float cover = stroke > 0.0 ? clamp(0.5 * stroke + 0.5 - abs(d), 0.0, 1.0)\n"
+            "                               : clamp(0.5 - d, 0.0, 1.0);\n"
+            "    if (cover <= 0.0) discard;\n"
+            "    vec4 c = gl_Color;\n"
+            "    if (textured) c *= texture2D(tex, a * 0.5 + 0.5);\n"
+            "    gl_FragColor = vec4(c.rgb, c.a * cover);\n"
+            "}\n";
+        GLuint vs = compile(GL_VERTEX_SHADER, vsSrc), fs = compile(GL_FRAGMENT_SHADER, fsSrc);
+        if (!vs || !fs) return false;
+        program = glCreateProgram();
+        glAttachShader(program, vs);
+        glAttachShader(program, fs);
+        glLinkProgram(program);
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+        GLint ok = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &ok);
+        if (!ok) { std::cerr << "sdf shapes: link failed\n"; program = 0; return false; }
+        strokeLoc   = glGetUniformLocation(program, "stroke");
+        texturedLoc = glGetUniformLocation(program, "textured");
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "tex"), 0);
+        glUseProgram(0);
+        return true;
+    }
+
+    bool ready() const { return program != 0; }
+
+    // Draw one shape with the current color and matrices; 'texture' 0 means
+    // untextured, otherwise it is mapped across the bounding square as
+    // u = (x - cx) / (2 rx) + 0.5.
+    void draw(const SdfShape& s, GLuint texture = 0) {
+        if (!program) return;
+        float pad = quadPadding(s.stroke);
+        float ex = s.rx + pad, ey = s.ry + pad;
+        begin(s.stroke, texture);
+        glMultiTexCoord2f(GL_TEXTURE1, s.rx, s.ry);
+        glBegin(GL_QUADS);
+          glTexCoord2f(-ex, -ey); glVertex2f(s.cx - ex, s.cy - ey);
+          glTexCoord2f( ex, -ey); glVertex2f(s.cx + ex, s.cy - ey);
+          glTexCoord2f( ex,  ey); glVertex2f(s.cx + ex, s.cy + ey);
+          glTexCoord2f(-ex,  ey); glVertex2f(s.cx - ex, s.cy + ey);
+        glEnd();
+        end();
+    }
+
+    // Untextured shapes with per-shape colors, BATCH at a time per draw call
+    void drawBatch(const SdfInstance* shapes, size_t count, float stroke) {
+        if (!program || !count) return;
+        const size_t BATCH = 16384;
+        float pad = quadPadding(stroke);
+        batch.resize(std::min(count, BATCH) * 4);
+        begin(stroke, 0);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), &batch[0].x);
+        glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(BatchVertex), &batch[0].color);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), &batch[0].lx);
+        glClientActiveTexture(GL_TEXTURE1);
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, sizeof(BatchVertex), &batch[0].rx);
+        for (size_t first = 0; first < count; first += BATCH) {
+            size_t n = std::min(BATCH, count - first);
+            for (size_t i = 0; i < n; ++i) {
+                const SdfInstance& s = shapes[first + i];
+                float ex = s.rx + pad, ey = s.ry + pad;
+                BatchVertex* q = &batch[i * 4];
+                q[0] = { s.cx - ex, s.cy - ey, -ex, -ey, s.rx, s.ry, s.color };
+                q[1] = { s.cx + ex, s.cy - ey,  ex, -ey, s.rx, s.ry, s.color };
+                q[2] = { s.cx + ex, s.cy + ey,  ex,  ey, s.rx, s.ry, s.color };
+                q[3] = { s.cx - ex, s.cy + ey, -ex,  ey, s.rx, s.ry, s.color };
+            }
+            glDrawArrays(GL_QUADS, 0, (GLsizei)(n * 4));
+        }
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glClientActiveTexture(GL_TEXTURE0);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        end();
+    }
+
+private:
+    struct BatchVertex {
+        float x, y, lx, ly, rx, ry;
+        uint32_t color;
+    };
+    GLuint program = 0;
+    GLint strokeLoc = -1, texturedLoc = -1;
+    std::vector<BatchVertex> batch;
+
+    // How far to grow a quad past the radii, in world units: half the
+    // stroke plus the AA ramp, from the current projection and viewport
+    static float quadPadding(float stroke) {
+        GLfloat proj[16];
+        GLint vp[4];
+        glGetFloatv(GL_PROJECTION_MATRIX, proj);
+        glGetIntegerv(GL_VIEWPORT, vp);
+        float wpp = std::max(2.0f / std::fabs(proj[0] * vp[2]), 2.0f / std::fabs(proj[5] * vp[3]));
+        return (0.5f * stroke + 1.5f) * wpp;
+    }
+
+    void begin(float stroke, GLuint texture) {
+        glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_TEXTURE_BIT);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glUseProgram(program);
+        glUniform1f(strokeLoc, stroke);
+        glUniform1i(texturedLoc, texture ? 1 : 0);
+    }
+
+    void end() {
+        glUseProgram(0);
+        glPopAttrib();
+    }
+
+    static GLuint compile(GLenum type, const char* src) {
+        GLuint s = glCreateShader(type);
+        glShaderSource(s, 1, &src, nullptr);
+        glCompileShader(s);
+        GLint ok = 0;
+        glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+        if (!ok) {
+            char log[1024];
+            glGetShaderInfoLog(s, sizeof(log), nullptr, log);
+            std::cerr << "sdf shapes: shader error: " << log << "\n";
+            glDeleteShader(s);
+            return 0;
+        }
+        return s;
+    }
+};
+
+// === CPU path ===
+namespace soft_detail {
+
+// Source-over blend of 'src' (RGBA floats in [0,1]) scaled by 'cover'
+inline uint32_t blendOver(uint32_t dst, const float* src, float cover) {
+    float a = src[3] * cover;
+#if defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i d16 = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)dst), zero);
+    __m128 d = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(d16, zero)), _mm_set1_ps(1.0f / 255.0f));
+    __m128 s = _mm_loadu_ps(src);
+    __m128 o = _mm_add_ps(d, _mm_mul_ps(_mm_sub_ps(s, d), _mm_set1_ps(a)));
+    // Destination alpha follows GL's blend: a*a + dstA*(1-a)
+    __m128i i = _mm_cvtps_epi32(_mm_mul_ps(o, _mm_set1_ps(255.0f)));
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+    uint32_t out = (uint32_t)_mm_cvtsi128_si32(i);
+    float da = ((dst >> 24) & 0xFF) / 255.0f;
+    return (out & 0x00FFFFFF) | (packRGBA(0, 0, 0, a * a + da * (1 - a)) & 0xFF000000);
+#else
+    float o[4];
+    for (int k = 0; k < 3; ++k) {
+        float d = ((dst >> (8 * k)) & 0xFF) / 255.0f;
+        o[k] = d + (src[k] - d) * a;
+    }
+    o[3] = a * a + ((dst >> 24) & 0xFF) / 255.0f * (1 - a);
+    return packRGBA(o[0], o[1], o[2], o[3]);
+#endif
+}
+
+} // namespace soft_detail
+
+// Draw one shape into 'fb', limited to 'clip'. 'color' is RGBA8 (packRGBA);
+// 'texture', if set, is modulated by it with the GL path's mapping.
+inline void rasterSdfShape(SoftFramebuffer& fb, const SdfShape& s, uint32_t color,
+                           const SoftTexture* texture, const SoftOrtho& view, SoftRect clip) {
+    // Everything in pixel units: distances come out in pixels directly
+    float cx = (s.cx - view.left) * view.sx(fb), cy = (s.cy - view.bottom) * view.sy(fb);
+    float rx = s.rx * view.sx(fb), ry = s.ry * view.sy(fb);
+    if (rx <= 0 || ry <= 0) return;
+    float pad = 0.5f * s.stroke + 1.0f;
+    int x0 = std::max(clip.x0, (int)std::floor(cx - rx - pad));
+    int y0 = std::max(clip.y0, (int)std::floor(cy - ry - pad));
+    int x1 = std::min(clip.x1, (int)std::ceil(cx + rx + pad));
+    int y1 = std::min(clip.y1, (int)std::ceil(cy + ry + pad));
+    if (x0 >= x1 || y0 >= y1) return;
+
+    float rgba[4];
+    for (int k = 0; k < 4; ++k) rgba[k] = ((color >> (8 * k)) & 0xFF) / 255.0f;
+    float lod = texture ? std::log2(std::max(1e-6f, texture->width() / (2.0f * rx))) : 0.0f;
+    const float irx = 1.0f / rx, iry = 1.0f / ry, irx2 = irx * irx, iry2 = iry * iry;
+    const float inner = -std::min(rx, ry), halfStroke = 0.5f * s.stroke;
+
+    auto shade = [&](uint32_t& dst, float x, float y, float cover) {
+        if (cover <= 0.0f) return;
+        float src[4] = { rgba[0], rgba[1], rgba[2], rgba[3] };
+        if (texture) {
+            float t[4];
+            texture->sample((x - cx) * irx * 0.5f + 0.5f, (y - cy) * iry * 0.5f + 0.5f, lod, t);
+            for (int k = 0; k < 4; ++k) src[k] *= t[k];
+        }
+        if (cover >= 1.0f && src[3] >= 1.0f)
+            dst = packRGBA(src[0], src[1], src[2], 1.0f);
+        else
+            dst = soft_detail::blendOver(dst, src, cover);
+    };
+
+    for (int y = y0; y < y1; ++y) {
+        uint32_t* row = fb.row(y);
+        float py = y + 0.5f, dy = py - cy;
+        int x = x0;
+#if defined(__SSE2__)
+        const __m128 ay2 = _mm_set1_ps(dy * iry * dy * iry), by2 = _mm_set1_ps(dy * iry2 * dy * iry2);
+        const __m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps(), half = _mm_set1_ps(0.5f);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        for (; x + 4 <= x1; x += 4) {
+            __m128 dx = _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float)x + 0.5f), _mm_set_ps(3, 2, 1, 0)),
+                                   _mm_set1_ps(cx));
+            __m128 ax = _mm_mul_ps(dx, _mm_set1_ps(irx)), bx = _mm_mul_ps(dx, _mm_set1_ps(irx2));
+            __m128 k0 = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ax, ax), ay2));
+            __m128 k1 = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(bx, bx), by2));
+            __m128 d = _mm_div_ps(_mm_mul_ps(k0, _mm_sub_ps(k0, one)), _mm_max_ps(k1, _mm_set1_ps(1e-20f)));
+            __m128 center = _mm_cmpeq_ps(k1, zero);
+            d = _mm_or_ps(_mm_and_ps(center, _mm_set1_ps(inner)), _mm_andnot_ps(center, d));
+            __m128 cover = s.stroke > 0
+                ? _mm_sub_ps(_mm_set1_ps(halfStroke + 0.5f), _mm_and_ps(d, absMask))
+                : _mm_sub_ps(half, d);
+            cover = _mm_min_ps(_mm_max_ps(cover, zero), one);
+            if (_mm_movemask_ps(_mm_cmpgt_ps(cover, zero)) == 0) continue;
+            float c[4];
+            _mm_storeu_ps(c, cover);
+            for (int k = 0; k < 4; ++k) shade(row[x + k], x + k + 0.5f, py, c[k]);
+        }
+#endif
+        for (; x < x1; ++x) {
+            float dx = x + 0.5f - cx;
+            float k0 = std::sqrt(dx * irx * dx * irx + dy * iry * dy * iry);
+            float k1 = std::sqrt(dx * irx2 * dx * irx2 + dy * iry2 * dy * iry2);
+            float d = k1 > 0 ? k0 * (k0 - 1.0f) / k1 : inner;
+            float cover = s.stroke > 0 ? halfStroke + 0.5f - std::fabs(d) : 0.5f - d;
+            shade(row[x], x + 0.5f, py, std::min(std::max(cover, 0.0f), 1.0f));
+        }
+    }
+}
+
+inline void rasterSdfShape(SoftFramebuffer& fb, const SdfShape& s, uint32_t color,
+                           const SoftTexture* texture, const SoftOrtho& view) {
+    rasterSdfShape(fb, s, color, texture, view, SoftRect{0, 0, fb.width, fb.height});
+}
@@ -0,0 +1,521 @@
+// soft_raster.h
+// Pure-CPU rendering backend for the demos: no GL driver involved.
+// Triangles are rasterized with edge functions (half-space tests) in 8x8
+// pixel tiles. A tile that lies fully inside or outside the triangle is
+// decided from its corners alone; partially covered tiles are tested a row
+// of 8 pixels at a time with SSE2 (AVX2 when enabled). Vertices snap to a
+// 1/16 pixel grid and the top-left fill rule decides pixels on shared
+// edges, so the output is deterministic. Colors and UVs are interpolated perspective-correctly.
+//
+// SoftContext mirrors the small part of immediate-mode GL the demos use
+// (glBegin/glVertex2f/glColor3f/...), so a draw function can feed either
+// backend through the same calls. With a TileScheduler attached, flush()
+// bins the queued triangles into screen tiles and rasterizes the tiles in
+// parallel; each tile still draws its triangles in submission order.
+// With a TileMask set, flush() only touches the marked tiles (partial
+// redraws, see damage.h). Polygons that leave the framebuffer are clipped
+// to it (poly_clip.h) before they are split into triangles.
+
+#pragma once
+
+#include <GL/gl.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "damage.h"
+#include "poly_clip.h"
+#include "soft_texture.h"
+#include "tile_scheduler.h"
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+const int SOFT_TILE          = 8;          // tile edge in pixels
+const int SOFT_SUBPIXEL_BITS = 4;          // 28.4 fixed-point vertices
+const int SOFT_SUBPIXEL      = 1 << SOFT_SUBPIXEL_BITS;
+const float SOFT_GUARD_BAND  = 131072.0f;  // max |coordinate| in pixels
+const int SOFT_BIN           = 64;         // scheduler tile edge in pixels
+const int SOFT_SPLIT_WORK    = 128;        // triangles per bin before it splits
+const int SOFT_SPLIT_MIN     = 16;         // smallest split tile edge
+
+// Packed 0xAABBGGRR, i.e. bytes R,G,B,A in memory (GL_RGBA / GL_UNSIGNED_BYTE)
+inline uint32_t packRGBA(float r, float g, float b, float a) {
+    auto c = [](float v) { return (uint32_t)(std::min(std::max(v, 0.0f), 1.0f) * 255.0f + 0.5f); };
+    return c(r) | (c(g) << 8) | (c(b) << 16) | (c(a) << 24);
+}
+
+// === Framebuffer ===
+// Row 0 is the bottom row, as in GL, so it can go straight to glDrawPixels.
+struct SoftFramebuffer {
+    int width = 0, height = 0;
+    std::vector<uint32_t> pixels;
+
+    void resize(int w, int h) {
+        width = w; height = h;
+        pixels.assign((size_t)w * h, 0);
+    }
+    void clear(uint32_t c) { std::fill(pixels.begin(), pixels.end(), c); }
+    uint32_t* row(int y) { return pixels.data() + (size_t)y * width; }
+    const uint32_t* row(int y) const { return pixels.data() + (size_t)y * width; }
+
+    // Copy 'r' from a framebuffer of the same size (a cached layer)
+    void copyRect(const SoftFramebuffer& src, const TileRect& r) {
+        int x0 = std::max(r.x0, 0), x1 = std::min(r.x1, width);
+        if (x0 >= x1) return;
+        for (int y = std::max(r.y0, 0); y < std::min(r.y1, height); ++y)
+            std::copy(src.row(y) + x0, src.row(y) + x1, row(y) + x0);
+    }
+};
+
+// World-to-pixel mapping of an orthographic view onto the framebuffer,
+// for CPU paths that bypass SoftContext
+struct SoftOrtho {
+    float left, right, bottom, top;
+    float sx(const SoftFramebuffer& fb) const { return fb.width / (right - left); }
+    float sy(const SoftFramebuffer& fb) const { return fb.height / (top - bottom); }
+};
+
+struct SoftVertex {
+    float x, y;       // window coordinates in pixels
+    float w;          // clip-space w (1 for orthographic projections)
+    float u, v;
+    float r, g, b, a;
+};
+
+struct SoftTriangle {
+    SoftVertex v[3];
+    const SoftTexture* texture;   // nullptr for flat/gouraud fills
+};
+
+// Half-open pixel rectangle, shared with the tile scheduler
+typedef TileRect SoftRect;
+
+// === Triangle setup ===
+namespace soft_detail {
+
+// E(X,Y) = A*X + B*Y + C over 28.4 coordinates; inside when E >= 0.
+// The top-left bias is folded into C.
+struct Edge {
+    int64_t A, B, C;
+};
+
+// Linear screen-space plane for one interpolated quantity
+struct Plane {
+    float atOrigin, dx, dy;
+    float at(float px, float py) const { return atOrigin + dx * px + dy * py; }
+};
+
+inline Edge makeEdge(int64_t ax, int64_t ay, int64_t bx, int64_t by) {
+    Edge e;
+    e.A = ay - by;
+    e.B = bx - ax;
+    e.C = -(e.A * ax + e.B * ay);
+    // Counter-clockwise with y up: left edges run downward, top edges run left
+    bool topLeft = e.A > 0 || (e.A == 0 && e.B < 0);
+    if (!topLeft) e.C -= 1;
+    return e;
+}
+
+inline int64_t evalEdge(const Edge& e, int px, int py) {
+    return e.A * ((int64_t)px * SOFT_SUBPIXEL + SOFT_SUBPIXEL / 2) +
+           e.B * ((int64_t)py * SOFT_SUBPIXEL + SOFT_SUBPIXEL / 2) + e.C;
+}
+
+inline Plane makePlane(const SoftVertex* v, float q0, float q1, float q2, double area) {
+    double dx1 = v[1].x - v[0].x, dy1 = v[1].y - v[0].y;
+    double dx2 = v[2].x - v[0].x, dy2 = v[2].y - v[0].y;
+    Plane p;
+    p.dx = (float)(((q1 - q0) * dy2 - (q2 - q0) * dy1) / area);
+    p.dy = (float)(((q2 - q0) * dx1 - (q1 - q0) * dx2) / area);
+    p.atOrigin = (float)(q0 - p.dx * v[0].x - p.dy * v[0].y);
+    return p;
+}
+
+// 8-bit coverage mask for 8 consecutive pixels: bit i set when lane i is
+// inside every edge listed in 'edges'. e0[k] is edge k at lane 0, step[k]
+// its increment per pixel.
+inline unsigned rowMask(const int32_t* e0, const int32_t* step, int edges) {
+#if defined(__AVX2__)
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i minusOne = _mm256_set1_epi32(-1);
+    __m256i in = minusOne;
+    for (int k = 0; k < edges; ++k) {
+        __m256i e = _mm256_add_epi32(_mm256_set1_epi32(e0[k]),
+                                     _mm256_mullo_epi32(lanes, _mm256_set1_epi32(step[k])));
+        in = _mm256_and_si256(in, _mm256_cmpgt_epi32(e, minusOne));
+    }
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(in));
+#elif defined(__SSE2__)
+    const __m128i minusOne = _mm_set1_epi32(-1);
+    __m128i lo = minusOne, hi = minusOne;
+    for (int k = 0; k < edges; ++k) {
+        // lanes 0..3 and 4..7
+        __m128i l0 = _mm_add_epi32(_mm_set1_epi32(e0[k]),
+                                   _mm_set_epi32(3 * step[k], 2 * step[k], step[k], 0));
+        __m128i l1 = _mm_add_epi32(l0, _mm_set1_epi32(4 * step[k]));
+        lo = _mm_and_si128(lo, _mm_cmpgt_epi32(l0, minusOne));
+        hi = _mm_and_si128(hi, _mm_cmpgt_epi32(l1, minusOne));
+    }
+    return (unsigned)_mm_movemask_ps(_mm_castsi128_ps(lo)) |
+           ((unsigned)_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4);
+#else
+    unsigned mask = 0xFF;
+    for (int k = 0; k < edges; ++k)
+        for (int i = 0; i < 8; ++i)
+            if (e0[k] + i * step[k] < 0) mask &= ~(1u << i);
+    return mask;
+#endif
+}
+
+} // namespace soft_detail
+
+// === Rasterize one triangle into 'fb', restricted to 'clip' ===
+inline void rasterTriangle(SoftFramebuffer& fb, const SoftTriangle& tri, SoftRect clip) {
+    using namespace soft_detail;
+    const SoftVertex* v = tri.v;
+    for (int i = 0; i < 3; ++i)
+        if (!(std::fabs(v[i].x) <= SOFT_GUARD_BAND && std::fabs(v[i].y) <= SOFT_GUARD_BAND))
+            return;   // outside the guard band (or NaN); SoftContext clips such geometry first
+
+    int64_t X[3], Y[3];
+    for (int i = 0; i < 3; ++i) {
+        X[i] = (int64_t)std::llround(v[i].x * SOFT_SUBPIXEL);
+        Y[i] = (int64_t)std::llround(v[i].y * SOFT_SUBPIXEL);
+    }
+    int64_t area2 = (X[1] - X[0]) * (Y[2] - Y[0]) - (X[2] - X[0]) * (Y[1] - Y[0]);
+    if (area2 == 0) return;
+    int i1 = 1, i2 = 2;               // no culling: flip clockwise triangles
+    if (area2 < 0) std::swap(i1, i2);
+
+    Edge edges[3] = {
+        makeEdge(X[i1], Y[i1], X[i2], Y[i2]),
+        makeEdge(X[i2], Y[i2], X[0],  Y[0]),
+        makeEdge(X[0],  Y[0],  X[i1], Y[i1]),
+    };
+
+    // Pixel bounding box, clipped to the framebuffer and the clip rect
+    int64_t minX = std::min({X[0], X[1], X[2]}), maxX = std::max({X[0], X[1], X[2]});
+    int64_t minY = std::min({Y[0], Y[1], Y[2]}), maxY = std::max({Y[0], Y[1], Y[2]});
+    int bx0 = std::max<int64_t>({(minX >> SOFT_SUBPIXEL_BITS), clip.x0, 0});
+    int by0 = std::max<int64_t>({(minY >> SOFT_SUBPIXEL_BITS), clip.y0, 0});
+    int bx1 = std::min<int64_t>({(maxX >> SOFT_SUBPIXEL_BITS) + 1, clip.x1, fb.width});
+    int by1 = std::min<int64_t>({(maxY >> SOFT_SUBPIXEL_BITS) + 1, clip.y1, fb.height});
+    if (bx0 >= bx1 || by0 >= by1) return;
+
+    // Perspective-correct attributes: interpolate q/w and 1/w linearly
+    double area = (double)(v[1].x - v[0].x) * (v[2].y - v[0].y) -
+                  (double)(v[2].x - v[0].x) * (v[1].y - v[0].y);
+    if (area == 0) return;
+    float iw[3], q[7][3];
+    for (int i = 0; i < 3; ++i) {
+        iw[i] = 1.0f / v[i].w;
+        const float attrs[7] = { 1.0f, v[i].u, v[i].v, v[i].r, v[i].g, v[i].b, v[i].a };
+        for (int k = 0; k < 7; ++k) q[k][i] = attrs[k] * iw[i];
+    }
+    Plane planes[7];
+    for (int k = 0; k < 7; ++k) planes[k] = makePlane(v, q[k][0], q[k][1], q[k][2], area);
+
+    auto shade = [&](int px, int py, uint32_t* dst) {
+        float cx = px + 0.5f, cy = py + 0.5f;
+        float w = 1.0f / planes[0].at(cx, cy);
+        float r = planes[3].at(cx, cy) * w, g = planes[4].at(cx, cy) * w;
+        float b = planes[5].at(cx, cy) * w, a = planes[6].at(cx, cy) * w;
+        if (tri.texture) {
+            const SoftTexture& tex = *tri.texture;
+            float u = planes[1].at(cx, cy) * w, tv = planes[2].at(cx, cy) * w;
+            float lod = 0.0f;
+            if (tex.usesLod()) {
+                // Exact screen derivatives of u = U/Q: du/dx = (U.dx - u*Q.dx) / Q
+                float dudx = (planes[1].dx - u * planes[0].dx) * w * tex.width();
+                float dvdx = (planes[2].dx - tv * planes[0].dx) * w * tex.height();
+                float dudy = (planes[1].dy - u * planes[0].dy) * w * tex.width();
+                float dvdy = (planes[2].dy - tv * planes[0].dy) * w * tex.height();
+                float rho2 = std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy);
+                lod = 0.5f * std::log2(std::max(rho2, 1e-12f));
+            }
+            float t[4];
+            tex.sample(u, tv, lod, t);
+            r *= t[0]; g *= t[1]; b *= t[2]; a *= t[3];
+        }
+        *dst = packRGBA(r, g, b, a);
+    };
+
+    // Walk 8x8 tiles aligned to the framebuffer grid
+    const int64_t span = (SOFT_TILE - 1) * SOFT_SUBPIXEL;
+    for (int ty = by0 & ~(SOFT_TILE - 1); ty < by1; ty += SOFT_TILE) {
+        for (int tx = bx0 & ~(SOFT_TILE - 1); tx < bx1; tx += SOFT_TILE) {
+            int32_t e0[3], stepX[3], stepY[3];
+            int partial = 0;
+            bool reject = false;
+            for (int k = 0; k < 3 && !reject; ++k) {
+                const Edge& e = edges[k];
+                int64_t at = evalEdge(e, tx, ty);
+                int64_t lo = at + std::min<int64_t>(0, e.A * span) + std::min<int64_t>(0, e.B * span);
+                int64_t hi = at + std::max<int64_t>(0, e.A * span) + std::max<int64_t>(0, e.B * span);
+                if (hi < 0) reject = true;          // tile fully outside this edge
+                else if (lo < 0) {                  // edge crosses the tile
+                    e0[partial] = (int32_t)at;
+                    stepX[partial] = (int32_t)(e.A * SOFT_SUBPIXEL);
+                    stepY[partial] = (int32_t)(e.B * SOFT_SUBPIXEL);
+                    ++partial;
+                }
+            }
+            if (reject) continue;
+
+            // Pixels of the tile that also lie in the bounding box
+            int x0 = std::max(tx, bx0), x1 = std::min(tx + SOFT_TILE, bx1);
+            int y0 = std::max(ty, by0), y1 = std::min(ty + SOFT_TILE, by1);
+            unsigned boxMask = ((1u << (x1 - tx)) - 1) & ~((1u << (x0 - tx)) - 1);
+
+            for (int y = y0; y < y1; ++y) {
+                unsigned mask = boxMask;
+                if (partial) {
+                    int32_t rowE[3];
+                    for (int k = 0; k < partial; ++k) rowE[k] = e0[k] + (y - ty) * stepY[k];
+                    mask &= rowMask(rowE, stepX, partial);
+                }
+                uint32_t* dst = fb.row(y) + tx;
+                while (mask) {
+                    int i = __builtin_ctz(mask);
+                    mask &= mask - 1;
+                    shade(tx + i, y, dst + i);
+                }
+            }
+        }
+    }
+}
+
+// === SoftContext: immediate-mode front end ===
+class SoftContext {
+public:
+    SoftFramebuffer fb;
+
+    void viewport(int w, int h) { fb.resize(w, h); }
+
+    // Orthographic projection, as gluOrtho2D/glOrtho for the 2D demos
+    void ortho(float l, float r, float b, float t) {
+        projL = l; projR = r; projB = b; projT = t;
+    }
+
+    // 2D affine modelview: x' = m[0]x + m[1]y + m[2], y' = m[3]x + m[4]y + m[5]
+    void loadIdentity() { mv = identity(); }
+    void pushMatrix() { stack.push_back(mv); }
+    void popMatrix() { if (!stack.empty()) { mv = stack.back(); stack.pop_back(); } }
+    void translate(float x, float y) { multiply({1, 0, x, 0, 1, y}); }
+    void scale(float sx, float sy) { multiply({sx, 0, 0, 0, sy, 0}); }
+    void rotate(float degrees) {
+        float a = degrees * 3.14159265f / 180.0f, c = std::cos(a), s = std::sin(a);
+        multiply({c, -s, 0, s, c, 0});
+    }
+
+    void clearColor(float r, float g, float b, float a) { clearValue = packRGBA(r, g, b, a); }
+    void clear() { triangles.clear(); fb.clear(clearValue); }
+
+    void color3f(float r, float g, float b) { cur.r = r; cur.g = g; cur.b = b; cur.a = 1.0f; }
+    void color4f(float r, float g, float b, float a) { cur.r = r; cur.g = g; cur.b = b; cur.a = a; }
+    void texCoord2f(float u, float v) { cur.u = u; cur.v = v; }
+    void lineWidth(float w) { lineW = w; }
+    void bindTexture(const SoftTexture* t) { texture = t; }
+    // Rasterize on these workers from now on; nullptr goes back to serial
+    void setScheduler(TileScheduler* s) { scheduler = s; }
+    // Limit flush() to the marked SOFT_BIN tiles; nullptr draws everywhere
+    void setTileMask(const TileMask* m) { tileMask = m; }
+
+    void begin(GLenum m) { mode = m; verts.clear(); }
+    void vertex2f(float x, float y) {
+        SoftVertex out = cur;
+        float wx = mv[0] * x + mv[1] * y + mv[2];
+        float wy = mv[3] * x + mv[4] * y + mv[5];
+        out.x = (wx - projL) / (projR - projL) * fb.width;
+        out.y = (wy - projB) / (projT - projB) * fb.height;
+        out.w = 1.0f;
+        verts.push_back(out);
+    }
+    void end() {
+        size_t n = verts.size();
+        switch (mode) {
+          case GL_TRIANGLES:
+            for (size_t i = 0; i + 2 < n; i += 3) emit(verts[i], verts[i + 1], verts[i + 2]);
+            break;
+          case GL_TRIANGLE_STRIP:
+            for (size_t i = 0; i + 2 < n; ++i) emit(verts[i], verts[i + 1], verts[i + 2]);
+            break;
+          case GL_TRIANGLE_FAN:
+            for (size_t i = 1; i + 1 < n; ++i) emit(verts[0], verts[i], verts[i + 1]);
+            break;
+          case GL_POLYGON:   // convex polygons only, as in GL
+            emitPolygon(verts.data(), n);
+            break;
+          case GL_QUADS:
+            for (size_t i = 0; i + 3 < n; i += 4) {
+                emit(verts[i], verts[i + 1], verts[i + 2]);
+                emit(verts[i], verts[i + 2], verts[i + 3]);
+            }
+            break;
+          case GL_LINES:
+            for (size_t i = 0; i + 1 < n; i += 2) emitLine(verts[i], verts[i + 1]);
+            break;
+          case GL_LINE_STRIP:
+          case GL_LINE_LOOP:
+            for (size_t i = 0; i + 1 < n; ++i) emitLine(verts[i], verts[i + 1]);
+            if (mode == GL_LINE_LOOP && n > 2) emitLine(verts[n - 1], verts[0]);
+            break;
+        }
+        verts.clear();
+    }
+
+    // Rasterize everything queued since the last clear/flush, in submission order
+    void flush() {
+        if (scheduler && scheduler->workerCount() > 1 && !triangles.empty()) {
+            flushTiled();
+        } else if (tileMask) {
+            for (int ty = 0; ty < tileMask->tilesY; ++ty)
+                for (int tx = 0; tx < tileMask->tilesX; ++tx) {
+                    if (!tileMask->test(tx, ty)) continue;
+                    SoftRect tile = { tx * SOFT_BIN, ty * SOFT_BIN, (tx + 1) * SOFT_BIN, (ty + 1) * SOFT_BIN };
+                    for (const SoftTriangle& t : triangles) rasterTriangle(fb, t, tile);
+                }
+        } else {
+            SoftRect all = { 0, 0, fb.width, fb.height };
+            for (const SoftTriangle& t : triangles) rasterTriangle(fb, t, all);
+        }
+        triangles.clear();
+    }
+
+private:
+    typedef std::array<float, 6> Mat;   // fixed size: transforms never touch the heap
+    static Mat identity() { return {1, 0, 0, 0, 1, 0}; }
+    void multiply(const Mat& b) {
+        Mat a = mv;
+        mv = { a[0] * b[0] + a[1] * b[3], a[0] * b[1] + a[1] * b[4], a[0] * b[2] + a[1] * b[5] + a[2],
+               a[3] * b[0] + a[4] * b[3], a[3] * b[1] + a[4] * b[4], a[3] * b[2] + a[4] * b[5] + a[5] };
+    }
+
+    // Bin triangles by bounding box into SOFT_BIN tiles (counting sort, as
+    // for the instanced circles), then one scheduler task per tile. A tile
+    // whose share of triangles is large splits into quadrants.
+    void flushTiled() {
+        int binsX = (fb.width + SOFT_BIN - 1) / SOFT_BIN, binsY = (fb.height + SOFT_BIN - 1) / SOFT_BIN;
+        size_t binCount = (size_t)binsX * binsY;
+        binStart.assign(binCount + 1, 0);
+        auto forEachBin = [&](const SoftTriangle& t, auto fn) {
+            const SoftVertex* v = t.v;
+            float minX = std::min({v[0].x, v[1].x, v[2].x}), maxX = std::max({v[0].x, v[1].x, v[2].x});
+            float minY = std::min({v[0].y, v[1].y, v[2].y}), maxY = std::max({v[0].y, v[1].y, v[2].y});
+            if (!(maxX >= 0 && maxY >= 0 && minX < fb.width && minY < fb.height)) return;
+            int bx0 = std::max(0, (int)minX / SOFT_BIN), bx1 = std::min(binsX - 1, (int)maxX / SOFT_BIN);
+            int by0 = std::max(0, (int)minY / SOFT_BIN), by1 = std::min(binsY - 1, (int)maxY / SOFT_BIN);
+            for (int by = by0; by <= by1; ++by)
+                for (int bx = bx0; bx <= bx1; ++bx) fn((size_t)by * binsX + bx);
+        };
+        for (const SoftTriangle& t : triangles)
+            forEachBin(t, [&](size_t b) { ++binStart[b + 1]; });
+        for (size_t b = 0; b < binCount; ++b) binStart[b + 1] += binStart[b];
+        binIndices.resize(binStart[binCount]);
+        binCursor.assign(binStart.begin(), binStart.end() - 1);
+        for (uint32_t i = 0; i < triangles.size(); ++i)
+            forEachBin(triangles[i], [&](size_t b) { binIndices[binCursor[b]++] = i; });
+
+        scheduler->run(fb.width, fb.height, SOFT_BIN, [&](const SoftRect& r, TileContext& ctx) {
+            if (tileMask && !tileMask->touches(r)) return;
+            size_t b = (size_t)(r.y0 / SOFT_BIN) * binsX + r.x0 / SOFT_BIN;
+            uint32_t first = binStart[b], last = binStart[b + 1];
+            // Estimated triangles for this piece of the bin, by area share
+            int64_t work = (int64_t)(last - first) * (r.x1 - r.x0) * (r.y1 - r.y0) / (SOFT_BIN * SOFT_BIN);
+            if (work > SOFT_SPLIT_WORK && r.x1 - r.x0 > SOFT_SPLIT_MIN) {
+                ctx.splitQuadrants(r);
+                return;
+            }
+            for (uint32_t k = first; k < last; ++k) rasterTriangle(fb, triangles[binIndices[k]], r);
+        });
+    }
+
+    void emit(const SoftVertex& a, const SoftVertex& b, const SoftVertex& c) {
+        auto inBand = [](const SoftVertex& p) {
+            return std::fabs(p.x) <= SOFT_GUARD_BAND && std::fabs(p.y) <= SOFT_GUARD_BAND;
+        };
+        if (inBand(a) && inBand(b) && inBand(c)) {
+            triangles.push_back({ { a, b, c }, texture });
+            return;
+        }
+        // Too far out for 28.4 fixed point: clip to the framebuffer instead
+        const SoftVertex tri[3] = { a, b, c };
+        clipPolygon(tri, 3);
+    }
+
+    // Convex polygon as a fan, clipped first when it leaves the framebuffer
+    void emitPolygon(const SoftVertex* v, size_t n) {
+        if (n < 3) return;
+        bool inside = true;
+        for (size_t i = 0; i < n && inside; ++i)
+            inside = v[i].x >= 0 && v[i].x <= fb.width && v[i].y >= 0 && v[i].y <= fb.height;
+        if (inside) {
+            for (size_t i = 1; i + 1 < n; ++i) triangles.push_back({ { v[0], v[i], v[i + 1] }, texture });
+            return;
+        }
+        clipPolygon(v, n);
+    }
+
+    // Clip against the framebuffer rectangle. Attributes travel as q/w and
+    // 1/w, which stay linear in screen space, so the clipped vertices keep
+    // perspective-correct values.
+    void clipPolygon(const SoftVertex* v, size_t n) {
+        clipper.setRect(0, (float)fb.width, 0, (float)fb.height);
+        clipIn.clear();
+        clipIn.beginPolygon();
+        for (size_t i = 0; i < n; ++i) {
+            float iw = 1.0f / v[i].w;
+            const float attrs[7] = { iw, v[i].u * iw, v[i].v * iw, v[i].r * iw, v[i].g * iw, v[i].b * iw, v[i].a * iw };
+            clipIn.vertex(v[i].x, v[i].y, attrs);
+        }
+        clipIn.endPolygon();
+        clipper.clip(clipIn, clipOut);
+        if (clipOut.polygonCount() == 0) return;
+
+        size_t count = clipOut.vertexCount[0];
+        clipVerts.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            SoftVertex& o = clipVerts[i];
+            float w = 1.0f / clipOut.attr[0][i];
+            o.x = clipOut.x[i]; o.y = clipOut.y[i]; o.w = w;
+            o.u = clipOut.attr[1][i] * w; o.v = clipOut.attr[2][i] * w;
+            o.r = clipOut.attr[3][i] * w; o.g = clipOut.attr[4][i] * w;
+            o.b = clipOut.attr[5][i] * w; o.a = clipOut.attr[6][i] * w;
+        }
+        for (size_t i = 1; i + 1 < count; ++i)
+            triangles.push_back({ { clipVerts[0], clipVerts[i], clipVerts[i + 1] }, texture });
+    }
+
+    // Lines become quads lineW pixels wide
+    void emitLine(const SoftVertex& a, const SoftVertex& b) {
+        float dx = b.x - a.x, dy = b.y - a.y, len = std::sqrt(dx * dx + dy * dy);
+        if (len == 0) return;
+        float nx = -dy / len * lineW * 0.5f, ny = dx / len * lineW * 0.5f;
+        SoftVertex q[4] = { a, b, b, a };
+        q[0].x += nx; q[0].y += ny;  q[1].x += nx; q[1].y += ny;
+        q[2].x -= nx; q[2].y -= ny;  q[3].x -= nx; q[3].y -= ny;
+        emit(q[0], q[1], q[2]);
+        emit(q[0], q[2], q[3]);
+    }
+
+    Mat mv = identity();
+    std::vector<Mat> stack;
+    float projL = -1, projR = 1, projB = -1, projT = 1;
+    uint32_t clearValue = 0xFF000000;
+    SoftVertex cur = { 0, 0, 1, 0, 0, 1, 1, 1, 1 };
+    float lineW = 1.0f;
+    const SoftTexture* texture = nullptr;
+    GLenum mode = GL_TRIANGLES;
+    std::vector<SoftVertex> verts;
+    std::vector<SoftTriangle> triangles;
+    TileScheduler* scheduler = nullptr;
+    const TileMask* tileMask = nullptr;
+    PolygonClipper clipper;
+    ClipBatch clipIn{7}, clipOut{7};
+    std::vector<SoftVertex> clipVerts;
+    std::vector<uint32_t> binStart, binIndices, binCursor;   // reused by flushTiled()
+};
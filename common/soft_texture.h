@@ -0,0 +1,150 @@
+// soft_texture.h
+// Texture storage and filtering for the CPU backend (soft_raster.h).
+// Each mip level is stored in 4x4-texel blocks, 64 bytes per block, so the
+// four texels of a bilinear footprint usually come from one cache line.
+// Filtering uses SSE2: a texel is widened to 4 float lanes (RGBA) and the
+// 4 bilinear taps, or 8 trilinear taps across two levels, are weighted and
+// summed in vector registers (taps fetched with an AVX2 gather when
+// enabled). Wrap (repeat) and clamp-to-edge addressing.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+enum class SoftWrap   { Repeat, Clamp };
+enum class SoftFilter { Nearest, Bilinear, Trilinear };
+
+const int SOFT_BLOCK = 4;   // texels per block edge
+
+struct SoftTexLevel {
+    int width = 0, height = 0;
+    int blocksX = 0;                 // blocks per block-row
+    std::vector<uint32_t> texels;    // block-swizzled RGBA8
+
+    // Index of texel (x,y) inside the swizzled array
+    size_t index(int x, int y) const {
+        size_t block = (size_t)(y >> 2) * blocksX + (x >> 2);
+        return block * (SOFT_BLOCK * SOFT_BLOCK) + ((y & 3) << 2) + (x & 3);
+    }
+    uint32_t at(int x, int y) const { return texels[index(x, y)]; }
+};
+
+class SoftTexture {
+public:
+    SoftWrap   wrap   = SoftWrap::Repeat;
+    SoftFilter filter = SoftFilter::Bilinear;
+
+    // Add the next mip level from linear (row-major, bottom row first) RGBA8 data
+    void addLevel(const uint32_t* linear, int w, int h) {
+        SoftTexLevel lvl;
+        lvl.width = w; lvl.height = h;
+        lvl.blocksX = (w + SOFT_BLOCK - 1) / SOFT_BLOCK;
+        int blocksY = (h + SOFT_BLOCK - 1) / SOFT_BLOCK;
+        lvl.texels.assign((size_t)lvl.blocksX * blocksY * SOFT_BLOCK * SOFT_BLOCK, 0);
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+                lvl.texels[lvl.index(x, y)] = linear[(size_t)y * w + x];
+        levels.push_back(std::move(lvl));
+    }
+    void clear() { levels.clear(); }
+
+    bool empty() const { return levels.empty(); }
+    int levelCount() const { return (int)levels.size(); }
+    int width() const { return levels.empty() ? 0 : levels[0].width; }
+    int height() const { return levels.empty() ? 0 : levels[0].height; }
+    bool usesLod() const { return filter == SoftFilter::Trilinear && levels.size() > 1; }
+
+    // Sample at (u,v) in [0,1] texture space. 'lod' is log2 of the texel
+    // footprint in level-0 texels; only trilinear filtering uses it.
+    // Result is 4 floats in [0,1] written to rgba.
+    void sample(float u, float v, float lod, float* rgba) const {
+        if (filter == SoftFilter::Nearest) {
+            const SoftTexLevel& l = levels[0];
+            int x = (int)std::floor(u * l.width), y = (int)std::floor(v * l.height);
+            unpack(l.at(address(x, l.width), address(y, l.height)), rgba);
+            return;
+        }
+        if (filter == SoftFilter::Bilinear || levels.size() == 1) {
+            bilinear(levels[0], u, v, 1.0f, rgba, false);
+            return;
+        }
+        float maxLod = (float)(levels.size() - 1);
+        lod = std::min(std::max(lod, 0.0f), maxLod);
+        int   l0 = (int)lod;
+        float t  = lod - l0;
+        if (t == 0.0f || l0 == (int)maxLod) {
+            bilinear(levels[l0], u, v, 1.0f, rgba, false);
+            return;
+        }
+        bilinear(levels[l0],     u, v, 1.0f - t, rgba, false);
+        bilinear(levels[l0 + 1], u, v, t,        rgba, true);
+    }
+
+private:
+    std::vector<SoftTexLevel> levels;
+
+    int address(int i, int size) const {
+        if (wrap == SoftWrap::Clamp) return std::min(std::max(i, 0), size - 1);
+        i %= size;
+        return i < 0 ? i + size : i;
+    }
+
+    static void unpack(uint32_t t, float* rgba) {
+        for (int k = 0; k < 4; ++k) rgba[k] = ((t >> (8 * k)) & 0xFF) * (1.0f / 255.0f);
+    }
+
+    // Weighted 2x2 footprint of one level; 'scale' weights the whole result
+    // (trilinear level blend) and 'accumulate' adds into rgba instead of storing.
+    void bilinear(const SoftTexLevel& l, float u, float v, float scale,
+                  float* rgba, bool accumulate) const {
+        float fx = u * l.width - 0.5f, fy = v * l.height - 0.5f;
+        float x0f = std::floor(fx), y0f = std::floor(fy);
+        float ax = fx - x0f, ay = fy - y0f;
+        int x0 = address((int)x0f, l.width),     x1 = address((int)x0f + 1, l.width);
+        int y0 = address((int)y0f, l.height),    y1 = address((int)y0f + 1, l.height);
+        float w00 = (1 - ax) * (1 - ay) * scale, w10 = ax * (1 - ay) * scale;
+        float w01 = (1 - ax) * ay * scale,       w11 = ax * ay * scale;
+#if defined(__SSE2__)
+        // All four taps in one register, widened 8 -> 16 -> 32 bit lanes
+        const __m128i zero = _mm_setzero_si128();
+#if defined(__AVX2__)
+        __m128i idx = _mm_set_epi32((int)l.index(x1, y1), (int)l.index(x0, y1),
+                                    (int)l.index(x1, y0), (int)l.index(x0, y0));
+        __m128i taps = _mm_i32gather_epi32((const int*)l.texels.data(), idx, 4);
+#else
+        __m128i taps = _mm_set_epi32((int)l.at(x1, y1), (int)l.at(x0, y1),
+                                     (int)l.at(x1, y0), (int)l.at(x0, y0));
+#endif
+        __m128i lo16 = _mm_unpacklo_epi8(taps, zero);           // t00, t10
+        __m128i hi16 = _mm_unpackhi_epi8(taps, zero);           // t01, t11
+        __m128 c00 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo16, zero));
+        __m128 c10 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo16, zero));
+        __m128 c01 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi16, zero));
+        __m128 c11 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi16, zero));
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c00, _mm_set1_ps(w00)),
+                                           _mm_mul_ps(c10, _mm_set1_ps(w10))),
+                                _mm_add_ps(_mm_mul_ps(c01, _mm_set1_ps(w01)),
+                                           _mm_mul_ps(c11, _mm_set1_ps(w11))));
+        sum = _mm_mul_ps(sum, _mm_set1_ps(1.0f / 255.0f));
+        if (accumulate) sum = _mm_add_ps(sum, _mm_loadu_ps(rgba));
+        _mm_storeu_ps(rgba, sum);
+#else
+        uint32_t t00 = l.at(x0, y0), t10 = l.at(x1, y0), t01 = l.at(x0, y1), t11 = l.at(x1, y1);
+        for (int k = 0; k < 4; ++k) {
+            int s = 8 * k;
+            float c = (((t00 >> s) & 0xFF) * w00 + ((t10 >> s) & 0xFF) * w10 +
+                       ((t01 >> s) & 0xFF) * w01 + ((t11 >> s) & 0xFF) * w11) * (1.0f / 255.0f);
+            rgba[k] = accumulate ? rgba[k] + c : c;
+        }
+#endif
+    }
+};
@@ -0,0 +1,197 @@
+// sparse_canvas.h
+// Virtual canvas for very large coordinate spaces: cells live in fixed
+// 256x256 tiles allocated the first time something is drawn on them, so
+// memory follows the touched area, not width x height. A 1M x 1M canvas
+// with a few lines on it holds a few tiles; a dense one would need 1 TB.
+//
+//   SparseCanvas<char> canvas(1000000, 1000000, '.');
+//   canvas.fillSpan(y, x0, x1, '#');        // [x0, x1) of row y
+//   canvas.set(x, y, '#');
+//   canvas.forEachTile([](const SparseTile<char>& t) { ... });   // drawn tiles only
+//   canvas.readRow(y, x0, x1, line.data());  // dense window, background filled in
+//
+// Tiles are found through a two-level page table: a directory of chunks of
+// 64x64 tile slots, each chunk allocated with its first tile. Lookups are
+// two indexings with no hashing, and tiles are visited in row-major order.
+// The directory holds one pointer per 16384x16384 cells, so sides up to a
+// few million cells cost next to nothing until drawn on. Row 0 is the
+// bottom row, as on the character canvases.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "bit_canvas.h"
+
+const int SPARSE_TILE_SHIFT = 8;
+const int SPARSE_TILE = 1 << SPARSE_TILE_SHIFT;          // tile side, cells
+const int SPARSE_CHUNK_SHIFT = 6;
+const int SPARSE_CHUNK = 1 << SPARSE_CHUNK_SHIFT;        // chunk side, tiles
+
+template <class Cell>
+struct SparseTile {
+    int tx, ty;                                // tile coordinates; cell x = tx * SPARSE_TILE + i
+    Cell cells[SPARSE_TILE * SPARSE_TILE];     // row-major, row 0 at the bottom
+
+    Cell* row(int r) { return cells + r * SPARSE_TILE; }
+    const Cell* row(int r) const { return cells + r * SPARSE_TILE; }
+};
+
+template <class Cell>
+class SparseCanvas {
+public:
+    typedef SparseTile<Cell> Tile;
+
+    SparseCanvas(int w = 0, int h = 0, Cell background = Cell()) { resize(w, h, background); }
+
+    // Drops every tile
+    void resize(int w, int h, Cell background = Cell()) {
+        width_ = w; height_ = h; bg = background;
+        int tilesX = (w + SPARSE_TILE - 1) >> SPARSE_TILE_SHIFT;
+        int tilesY = (h + SPARSE_TILE - 1) >> SPARSE_TILE_SHIFT;
+        chunksX = (tilesX + SPARSE_CHUNK - 1) >> SPARSE_CHUNK_SHIFT;
+        chunksY = (tilesY + SPARSE_CHUNK - 1) >> SPARSE_CHUNK_SHIFT;
+        directory.clear();
+        directory.resize((size_t)chunksX * chunksY);
+        tileCount_ = 0;
+        last = nullptr;
+    }
+    int width() const { return width_; }
+    int height() const { return height_; }
+    Cell background() const { return bg; }
+
+    // Frees every tile; the canvas is all background again
+    void clear() { resize(width_, height_, bg); }
+
+    // Tiles allocated, and the memory they and the page table take
+    size_t tileCount() const { return tileCount_; }
+    size_t bytes() const {
+        size_t chunks = 0;
+        for (auto& c : directory) chunks += c != nullptr;
+        return tileCount_ * sizeof(Tile) + chunks * sizeof(Chunk) + directory.size() * sizeof(directory[0]);
+    }
+
+    void set(int x, int y, Cell value) {
+        if (x < 0 || x >= width_ || y < 0 || y >= height_) return;
+        Tile* t = tileFor(x >> SPARSE_TILE_SHIFT, y >> SPARSE_TILE_SHIFT);
+        t->row(y & (SPARSE_TILE - 1))[x & (SPARSE_TILE - 1)] = value;
+    }
+
+    // Value at (x, y); background outside the canvas or on untouched tiles
+    Cell at(int x, int y) const {
+        if (x < 0 || x >= width_ || y < 0 || y >= height_) return bg;
+        const Tile* t = find(x >> SPARSE_TILE_SHIFT, y >> SPARSE_TILE_SHIFT);
+        return t ? t->row(y & (SPARSE_TILE - 1))[x & (SPARSE_TILE - 1)] : bg;
+    }
+
+    // Set [x0, x1) of row y (clipped), one tile row segment at a time
+    void fillSpan(int y, int x0, int x1, Cell value) {
+        if (y < 0 || y >= height_) return;
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, width_);
+        int ty = y >> SPARSE_TILE_SHIFT, r = y & (SPARSE_TILE - 1);
+        while (x0 < x1) {
+            int tx = x0 >> SPARSE_TILE_SHIFT;
+            int end = std::min(x1, (tx + 1) << SPARSE_TILE_SHIFT);
+            Cell* row = tileFor(tx, ty)->row(r);
+            std::fill(row + (x0 & (SPARSE_TILE - 1)), row + (end - (tx << SPARSE_TILE_SHIFT)), value);
+            x0 = end;
+        }
+    }
+
+    // Tile (tx, ty) if it has been drawn on, else null
+    const Tile* find(int tx, int ty) const {
+        if (last && last->tx == tx && last->ty == ty) return last;
+        const Chunk* c = directory[(size_t)(ty >> SPARSE_CHUNK_SHIFT) * chunksX + (tx >> SPARSE_CHUNK_SHIFT)].get();
+        if (!c) return nullptr;
+        return c->slot[(ty & (SPARSE_CHUNK - 1)) * SPARSE_CHUNK + (tx & (SPARSE_CHUNK - 1))].get();
+    }
+
+    // Calls f(const Tile&) for each allocated tile, in row-major tile order.
+    // Cells of a tile past the canvas edge are background.
+    template <class F>
+    void forEachTile(F f) const {
+        for (int cy = 0; cy < chunksY; ++cy)
+            for (int j = 0; j < SPARSE_CHUNK; ++j)
+                for (int cx = 0; cx < chunksX; ++cx) {
+                    const Chunk* c = directory[(size_t)cy * chunksX + cx].get();
+                    if (!c) continue;
+                    const std::unique_ptr<Tile>* row = c->slot + j * SPARSE_CHUNK;
+                    for (int i = 0; i < SPARSE_CHUNK; ++i)
+                        if (row[i]) f(*row[i]);
+                }
+    }
+
+    // Row y, columns [x0, x1) (within the canvas), as x1 - x0 values
+    void readRow(int y, int x0, int x1, Cell* out) const {
+        int ty = y >> SPARSE_TILE_SHIFT, r = y & (SPARSE_TILE - 1);
+        while (x0 < x1) {
+            int tx = x0 >> SPARSE_TILE_SHIFT;
+            int end = std::min(x1, (tx + 1) << SPARSE_TILE_SHIFT);
+            const Tile* t = find(tx, ty);
+            if (t) {
+                const Cell* row = t->row(r) + (x0 & (SPARSE_TILE - 1));
+                out = std::copy(row, row + (end - x0), out);
+            } else {
+                out = std::fill_n(out, end - x0, bg);
+            }
+            x0 = end;
+        }
+    }
+
+    // Cells that are not background, and their bounding box (false if
+    // none); both visit only the allocated tiles
+    uint64_t count() const {
+        uint64_t n = 0;
+        forEachTile([&](const Tile& t) {
+            for (const Cell& c : t.cells) n += !(c == bg);
+        });
+        return n;
+    }
+    bool boundingBox(BitRect& box) const {
+        box = { width_, height_, 0, 0 };
+        forEachTile([&](const Tile& t) {
+            for (int r = 0; r < SPARSE_TILE; ++r) {
+                const Cell* row = t.row(r);
+                int i0 = 0, i1 = SPARSE_TILE;
+                while (i0 < i1 && row[i0] == bg) ++i0;
+                if (i0 == i1) continue;
+                while (row[i1 - 1] == bg) --i1;
+                int x = t.tx << SPARSE_TILE_SHIFT, y = (t.ty << SPARSE_TILE_SHIFT) + r;
+                box = { std::min(box.x0, x + i0), std::min(box.y0, y),
+                        std::max(box.x1, x + i1), std::max(box.y1, y + 1) };
+            }
+        });
+        return box.x0 < box.x1;
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<Tile> slot[SPARSE_CHUNK * SPARSE_CHUNK];
+    };
+
+    // Tile (tx, ty), allocated and filled with background on first use
+    Tile* tileFor(int tx, int ty) {
+        if (last && last->tx == tx && last->ty == ty) return last;
+        std::unique_ptr<Chunk>& c = directory[(size_t)(ty >> SPARSE_CHUNK_SHIFT) * chunksX + (tx >> SPARSE_CHUNK_SHIFT)];
+        if (!c) c.reset(new Chunk());
+        std::unique_ptr<Tile>& t = c->slot[(ty & (SPARSE_CHUNK - 1)) * SPARSE_CHUNK + (tx & (SPARSE_CHUNK - 1))];
+        if (!t) {
+            t.reset(new Tile);
+            t->tx = tx; t->ty = ty;
+            std::fill(t->cells, t->cells + SPARSE_TILE * SPARSE_TILE, bg);
+            ++tileCount_;
+        }
+        last = t.get();
+        return last;
+    }
+
+    int width_ = 0, height_ = 0;
+    Cell bg = Cell();
+    int chunksX = 0, chunksY = 0;
+    std::vector<std::unique_ptr<Chunk>> directory;   // chunksX * chunksY, row-major
+    size_t tileCount_ = 0;
+    Tile* last = nullptr;                            // most recently used tile
+};
@@ -0,0 +1,225 @@
+// stroke.h
+// CPU stroker: turns polylines into indexed triangles with miter, round or
+// bevel joins and butt, round or square caps, so thick outlines look the
+// same on every driver (glLineWidth beyond 1 is optional in GL and capped
+// on llvmpipe) and through the CPU backend.
+//
+//   StrokeMesh axes;
+//   if (axes.begin(StrokeStyle{ 2.0f }, viewKey)) {   // rebuild only when the key changes
+//       axes.setPixelScale(w / (r - l), h / (t - b));
+//       axes.addPolyline(pts, n);                     // as many as needed
+//       axes.end();
+//   }
+//   glVertexPointer(2, GL_FLOAT, 0, axes.vertices.data());
+//   glDrawElements(GL_TRIANGLES, axes.indices.size(), GL_UNSIGNED_INT, axes.indices.data());
+//
+// Widths and tolerances are in pixels; points and output are in world
+// units, mapped through the pixel scale, so strokes keep their pixel width
+// under any aspect ratio. Each segment is a quad (a two-triangle strip)
+// and joins fill the wedge on the outer side of each turn; the pieces
+// overlap on the inner side, which is invisible for opaque strokes.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+enum class StrokeJoin { Miter, Round, Bevel };
+enum class StrokeCap { Butt, Round, Square };
+
+struct StrokeStyle {
+    float width = 1.0f;                // pixels
+    StrokeJoin join = StrokeJoin::Miter;
+    StrokeCap cap = StrokeCap::Butt;
+    float miterLimit = 4.0f;           // miter length / width before falling back to bevel
+    float tolerance = 0.25f;           // max pixel deviation of round joins and caps
+};
+
+struct StrokeVertex {
+    float x, y;
+};
+
+// FNV-1a, for building the keys that decide when a mesh is rebuilt
+inline uint64_t strokeHash(const void* data, size_t bytes, uint64_t seed = 1469598103934665603ull) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < bytes; ++i) seed = (seed ^ p[i]) * 1099511628211ull;
+    return seed;
+}
+
+class StrokeMesh {
+public:
+    std::vector<StrokeVertex> vertices;   // world units
+    std::vector<uint32_t> indices;        // triangles
+
+    // Start a batch for 'key' (anything that identifies the paths and the
+    // view). Returns false if the mesh already holds this batch, in which
+    // case there is nothing to add; true means add the polylines and end().
+    bool begin(const StrokeStyle& s, uint64_t key) {
+        uint64_t full = strokeHash(&s, sizeof(s), key);
+        if (valid && full == builtKey) return false;
+        style = s;
+        builtKey = full;
+        valid = false;
+        vertices.clear();
+        indices.clear();
+        sx = sy = 1.0f;
+        return true;
+    }
+    void end() { valid = true; }
+    // Force a rebuild at the next begin()
+    void invalidate() { valid = false; }
+
+    // World units to pixels; set before adding polylines
+    void setPixelScale(float pxPerUnitX, float pxPerUnitY) {
+        sx = pxPerUnitX;
+        sy = pxPerUnitY;
+    }
+
+    // Any point type with .x and .y; 'closed' joins the last point to the
+    // first instead of capping both ends
+    template <class Point>
+    void addPolyline(const Point* pts, size_t count, bool closed = false) {
+        path.clear();
+        for (size_t i = 0; i < count; ++i) {
+            P p = { pts[i].x * sx, pts[i].y * sy };
+            if (path.empty() || p.x != path.back().x || p.y != path.back().y) path.push_back(p);
+        }
+        if (closed && path.size() > 1 && path.front().x == path.back().x && path.front().y == path.back().y)
+            path.pop_back();
+        strokePath(closed && path.size() > 2);
+    }
+
+    // Two-point polyline
+    void addSegment(float x0, float y0, float x1, float y1) {
+        const StrokeVertex p[2] = { { x0, y0 }, { x1, y1 } };
+        addPolyline(p, 2);
+    }
+
+private:
+    struct P {
+        float x, y;
+    };
+
+    uint32_t emit(P p) {
+        vertices.push_back({ p.x / sx, p.y / sy });
+        return (uint32_t)vertices.size() - 1;
+    }
+    void triangle(uint32_t a, uint32_t b, uint32_t c) {
+        indices.push_back(a); indices.push_back(b); indices.push_back(c);
+    }
+
+    // Arc steps for a turn of 'angle' radians at radius 'r' pixels
+    int arcSteps(float angle, float r) const {
+        float tol = std::min(style.tolerance, r);
+        float step = 2.0f * std::acos(1.0f - tol / std::max(r, 1e-6f));
+        return std::max(1, (int)std::ceil(std::fabs(angle) / std::max(step, 1e-3f)));
+    }
+
+    // Fan around 'c' from direction a0 turning by 'sweep' (radians)
+    void fan(P c, float r, float a0, float sweep) {
+        int steps = arcSteps(sweep, r);
+        uint32_t center = emit(c);
+        uint32_t prev = emit({ c.x + r * std::cos(a0), c.y + r * std::sin(a0) });
+        for (int i = 1; i <= steps; ++i) {
+            float a = a0 + sweep * i / steps;
+            uint32_t cur = emit({ c.x + r * std::cos(a), c.y + r * std::sin(a) });
+            triangle(center, prev, cur);
+            prev = cur;
+        }
+    }
+
+    void strokePath(bool closed) {
+        size_t n = path.size();
+        float h = style.width * 0.5f;
+        if (n < 2) {
+            // A lone point shows only through its caps
+            if (n == 1 && style.cap == StrokeCap::Round) fan(path[0], h, 0.0f, 6.2831853f);
+            if (n == 1 && style.cap == StrokeCap::Square) {
+                P c = path[0];
+                uint32_t a = emit({ c.x - h, c.y - h }), b = emit({ c.x + h, c.y - h });
+                uint32_t d = emit({ c.x + h, c.y + h }), e = emit({ c.x - h, c.y + h });
+                triangle(a, b, d); triangle(a, d, e);
+            }
+            return;
+        }
+
+        size_t segments = closed ? n : n - 1;
+        dirs.resize(segments);
+        for (size_t i = 0; i < segments; ++i) {
+            P a = path[i], b = path[(i + 1) % n];
+            float dx = b.x - a.x, dy = b.y - a.y, len = std::sqrt(dx * dx + dy * dy);
+            dirs[i] = { dx / len, dy / len };
+        }
+
+        // Segment bodies
+        for (size_t i = 0; i < segments; ++i) {
+            P a = path[i], b = path[(i + 1) % n], d = dirs[i];
+            if (!closed && style.cap == StrokeCap::Square) {
+                if (i == 0) { a.x -= d.x * h; a.y -= d.y * h; }
+                if (i + 1 == segments) { b.x += d.x * h; b.y += d.y * h; }
+            }
+            float nx = -d.y * h, ny = d.x * h;
+            uint32_t v0 = emit({ a.x + nx, a.y + ny }), v1 = emit({ a.x - nx, a.y - ny });
+            uint32_t v2 = emit({ b.x + nx, b.y + ny }), v3 = emit({ b.x - nx, b.y - ny });
+            triangle(v0, v1, v2);
+            triangle(v2, v1, v3);
+        }
+
+        // Joins between consecutive segments
+        for (size_t j = closed ? 0 : 1; j < (closed ? n : n - 1); ++j) {
+            P d0 = dirs[(j + segments - 1) % segments], d1 = dirs[j % segments];
+            join(path[j], d0, d1, h);
+        }
+
+        // Round caps
+        if (!closed && style.cap == StrokeCap::Round) {
+            P d = dirs[0];
+            fan(path[0], h, std::atan2(d.x, -d.y), 3.14159265f);          // from +normal around the back
+            d = dirs[segments - 1];
+            fan(path[n - 1], h, std::atan2(-d.x, d.y), 3.14159265f);      // from -normal around the front
+        }
+    }
+
+    void join(P p, P d0, P d1, float h) {
+        float cross = d0.x * d1.y - d0.y * d1.x, dot = d0.x * d1.x + d0.y * d1.y;
+        if (std::fabs(cross) < 1e-6f && dot > 0) return;      // straight on
+        // Outer side: right of the path for a left turn, left for a right turn
+        float side = cross > 0 ? -1.0f : 1.0f;
+        P o0 = { -d0.y * side, d0.x * side }, o1 = { -d1.y * side, d1.x * side };
+
+        if (style.join == StrokeJoin::Round) {
+            // From o0 to o1 the short way
+            float sweep = std::atan2(o0.x * o1.y - o0.y * o1.x, o0.x * o1.x + o0.y * o1.y);
+            fan(p, h, std::atan2(o0.y, o0.x), sweep);
+            return;
+        }
+
+        uint32_t c = emit(p);
+        uint32_t a = emit({ p.x + o0.x * h, p.y + o0.y * h });
+        uint32_t b = emit({ p.x + o1.x * h, p.y + o1.y * h });
+        if (style.join == StrokeJoin::Miter) {
+            P m = { o0.x + o1.x, o0.y + o1.y };
+            float mlen = std::sqrt(m.x * m.x + m.y * m.y);
+            if (mlen > 1e-6f) {
+                m.x /= mlen; m.y /= mlen;
+                float ratio = 1.0f / (m.x * o0.x + m.y * o0.y);      // miter length / width
+                if (ratio <= style.miterLimit) {
+                    uint32_t tip = emit({ p.x + m.x * h * ratio, p.y + m.y * h * ratio });
+                    triangle(c, a, tip);
+                    triangle(c, tip, b);
+                    return;
+                }
+            }
+        }
+        triangle(c, a, b);   // bevel, or a miter over the limit
+    }
+
+    StrokeStyle style;
+    uint64_t builtKey = 0;
+    bool valid = false;
+    float sx = 1.0f, sy = 1.0f;
+    std::vector<P> path, dirs;   // scratch, pixel units
+};
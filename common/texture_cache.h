@@ -0,0 +1,286 @@
+// texture_cache.h
+// Decoded-texture cache shared by the textured demos.
+// Decoding a JPEG and building its mip chain costs far more than reading
+// the result back, so the decoded RGBA levels are written once to a cache
+// file named after a hash of the source bytes and memory-mapped on later runs.
+// The cache is best-effort: when it cannot be written (read-only checkout,
+// full disk), the freshly decoded levels are used from memory.
+// Linux/POSIX only (mmap); decoding goes through SOIL.
+
+#pragma once
+
+#include <SOIL/SOIL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// === Cache file layout ===
+// [CacheHeader][pixel data of level 0][level 1]... each level 64-byte aligned.
+const uint32_t TEXCACHE_MAGIC   = 0x31435854; // "TXC1"
+const int      TEXCACHE_MAXMIPS = 16;
+
+struct MipLevel {
+    uint32_t width, height;
+    uint64_t offset;   // byte offset of the level from the start of the file
+};
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t levelCount;
+    uint64_t sourceHash;
+    uint64_t totalSize;
+    MipLevel levels[TEXCACHE_MAXMIPS];
+};
+
+// 64-bit FNV-1a, good enough to key a cache on file contents
+inline uint64_t fnv1a64(const unsigned char* data, size_t n) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= data[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+inline uint64_t alignUp(uint64_t v, uint64_t a) { return (v + a - 1) & ~(a - 1); }
+
+// === DecodedTexture ===
+// Read-only view of a decoded texture in the cache file layout: either a
+// mapped cache file (unmapped on destruction) or an image held in memory.
+class DecodedTexture {
+    void*  base = nullptr;
+    size_t size = 0;
+    std::vector<unsigned char> memory;   // the image when not mapped
+
+public:
+    DecodedTexture() = default;
+    DecodedTexture(const DecodedTexture&) = delete;
+    DecodedTexture& operator=(const DecodedTexture&) = delete;
+    DecodedTexture(DecodedTexture&& o) noexcept { *this = std::move(o); }
+    DecodedTexture& operator=(DecodedTexture&& o) noexcept {
+        if (this != &o) {
+            release();
+            base = o.base; size = o.size;
+            memory = std::move(o.memory);        // keeps its buffer, so 'base' stays valid
+            o.base = nullptr; o.size = 0;
+        }
+        return *this;
+    }
+    ~DecodedTexture() { release(); }
+
+    bool mapFile(const std::string& path) {
+        release();
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(CacheHeader)) { close(fd); return false; }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        base = p; size = st.st_size;
+
+        // Reject truncated or foreign files so the caller re-decodes
+        const CacheHeader& h = header();
+        if (h.magic != TEXCACHE_MAGIC || h.totalSize != size ||
+            h.levelCount == 0 || h.levelCount > TEXCACHE_MAXMIPS || !levelsValid()) {
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    // Every level must lie inside the mapping, after the header and the
+    // level before it, and halve the previous one's size down to 1x1 (or
+    // TEXCACHE_MAXMIPS levels), as decodeTextureLevels lays it out; pixels(i)
+    // and the upload read straight through these offsets.
+    bool levelsValid() const {
+        const CacheHeader& h = header();
+        uint64_t end = sizeof(CacheHeader);   // first byte a level may use
+        for (uint32_t i = 0; i < h.levelCount; ++i) {
+            const MipLevel& l = h.levels[i];
+            if (l.width == 0 || l.height == 0 || l.offset % 64 != 0 ||
+                l.offset < end || l.offset > size) return false;
+            if (i > 0) {
+                const MipLevel& prev = h.levels[i - 1];
+                if (l.width != std::max(1u, prev.width / 2) || l.height != std::max(1u, prev.height / 2) ||
+                    (prev.width == 1 && prev.height == 1)) return false;
+            }
+            uint64_t pixels = (uint64_t)l.width * l.height;   // cannot overflow: both < 2^32
+            if (pixels > (size - l.offset) / 4) return false;
+            end = l.offset + pixels * 4;
+        }
+        const MipLevel& last = h.levels[h.levelCount - 1];
+        return h.levelCount == TEXCACHE_MAXMIPS || (last.width == 1 && last.height == 1);
+    }
+
+    // Take a complete image built by decodeTextureLevels
+    void adopt(std::vector<unsigned char>&& image) {
+        release();
+        memory = std::move(image);
+        base = memory.data(); size = memory.size();
+    }
+
+    void release() {
+        if (base && memory.empty()) munmap(base, size);
+        memory.clear();
+        memory.shrink_to_fit();
+        base = nullptr; size = 0;
+    }
+
+    bool valid() const { return base != nullptr; }
+    const CacheHeader& header() const { return *static_cast<const CacheHeader*>(base); }
+    int levels() const { return valid() ? (int)header().levelCount : 0; }
+    const MipLevel& level(int i) const { return header().levels[i]; }
+    const unsigned char* pixels(int i) const {
+        return static_cast<const unsigned char*>(base) + header().levels[i].offset;
+    }
+    // Byte range holding all levels, used to fill a staging buffer in one copy
+    uint64_t dataOffset() const { return header().levels[0].offset; }
+    uint64_t dataSize() const { return header().totalSize - dataOffset(); }
+    const unsigned char* data() const { return pixels(0); }
+};
+
+// === Mip chain construction ===
+// 2x2 box filter; odd edges reuse the last row/column.
+inline void downsampleRGBA(const unsigned char* src, int sw, int sh,
+                           unsigned char* dst, int dw, int dh) {
+    for (int y = 0; y < dh; ++y) {
+        int y0 = std::min(2 * y, sh - 1), y1 = std::min(2 * y + 1, sh - 1);
+        for (int x = 0; x < dw; ++x) {
+            int x0 = std::min(2 * x, sw - 1), x1 = std::min(2 * x + 1, sw - 1);
+            const unsigned char* a = src + (y0 * sw + x0) * 4;
+            const unsigned char* b = src + (y0 * sw + x1) * 4;
+            const unsigned char* c = src + (y1 * sw + x0) * 4;
+            const unsigned char* d = src + (y1 * sw + x1) * 4;
+            for (int k = 0; k < 4; ++k)
+                dst[(y * dw + x) * 4 + k] = (unsigned char)((a[k] + b[k] + c[k] + d[k] + 2) >> 2);
+        }
+    }
+}
+
+// Decode the image with SOIL into 'file', laid out as a complete cache file
+inline bool decodeTextureLevels(const std::vector<unsigned char>& bytes, uint64_t hash,
+                                std::vector<unsigned char>& file, std::string& err) {
+    int w = 0, h = 0, channels = 0;
+    unsigned char* img = SOIL_load_image_from_memory(bytes.data(), (int)bytes.size(),
+                                                     &w, &h, &channels, SOIL_LOAD_RGBA);
+    if (!img) { err = SOIL_last_result(); return false; }
+
+    CacheHeader hdr = {};
+    hdr.magic = TEXCACHE_MAGIC;
+    hdr.sourceHash = hash;
+    uint64_t offset = alignUp(sizeof(CacheHeader), 64);
+    for (int lw = w, lh = h; hdr.levelCount < (uint32_t)TEXCACHE_MAXMIPS; ) {
+        hdr.levels[hdr.levelCount++] = { (uint32_t)lw, (uint32_t)lh, offset };
+        offset = alignUp(offset + (uint64_t)lw * lh * 4, 64);
+        if (lw == 1 && lh == 1) break;
+        lw = std::max(1, lw / 2);
+        lh = std::max(1, lh / 2);
+    }
+    hdr.totalSize = offset;
+
+    file.assign(offset, 0);
+    std::memcpy(file.data(), &hdr, sizeof(hdr));
+
+    // Level 0, flipped vertically to match SOIL_FLAG_INVERT_Y
+    unsigned char* lvl0 = file.data() + hdr.levels[0].offset;
+    for (int y = 0; y < h; ++y)
+        std::memcpy(lvl0 + (size_t)y * w * 4, img + (size_t)(h - 1 - y) * w * 4, (size_t)w * 4);
+    SOIL_free_image_data(img);
+
+    for (uint32_t i = 1; i < hdr.levelCount; ++i) {
+        const MipLevel& s = hdr.levels[i - 1];
+        const MipLevel& d = hdr.levels[i];
+        downsampleRGBA(file.data() + s.offset, s.width, s.height,
+                       file.data() + d.offset, d.width, d.height);
+    }
+    return true;
+}
+
+// Write a decoded image to 'cachePath'. The file is written under a
+// temporary name and renamed, so a crash never leaves a half-written
+// entry behind.
+inline bool writeTextureCache(const std::vector<unsigned char>& file, const std::string& cachePath,
+                              std::string& err) {
+    std::string tmp = cachePath + ".tmp";
+    {
+        std::ofstream ofs(tmp, std::ios::binary);
+        if (!ofs) { err = "cannot write " + tmp; return false; }
+        ofs.write(reinterpret_cast<const char*>(file.data()), file.size());
+        if (!ofs) { err = "short write to " + tmp; std::remove(tmp.c_str()); return false; }
+    }
+    if (std::rename(tmp.c_str(), cachePath.c_str()) != 0) {
+        err = "cannot rename " + tmp;
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Load 'imagePath' through the cache in 'cacheDir'. Only the source bytes
+// are read when the cache is warm; the JPEG is decoded on a miss and the
+// result kept in memory, whether or not it could be cached. Fails only
+// when the image itself cannot be read or decoded.
+inline bool loadTextureCached(const std::string& imagePath, const std::string& cacheDir,
+                              DecodedTexture& out, std::string& err) {
+    std::ifstream ifs(imagePath, std::ios::binary);
+    if (!ifs) { err = "cannot open " + imagePath; return false; }
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(ifs)),
+                                     std::istreambuf_iterator<char>());
+    uint64_t hash = fnv1a64(bytes.data(), bytes.size());
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.rgba", (unsigned long long)hash);
+    mkdir(cacheDir.c_str(), 0755);
+    std::string cachePath = cacheDir + "/" + name;
+
+    if (out.mapFile(cachePath) && out.header().sourceHash == hash) return true;
+    std::vector<unsigned char> file;
+    if (!decodeTextureLevels(bytes, hash, file, err)) return false;
+    std::string cacheErr;
+    if (!writeTextureCache(file, cachePath, cacheErr))
+        std::fprintf(stderr, "texture cache: %s; using the decoded image uncached\n", cacheErr.c_str());
+    out.adopt(std::move(file));
+    return true;
+}
+
+// === AsyncTextureLoader ===
+// Runs loadTextureCached on a worker thread. The GL thread polls ready()
+// (e.g. from a GLUT timer) and then take()s the mapped result to upload it.
+class AsyncTextureLoader {
+    std::thread       worker;
+    std::atomic<int>  state{0};   // 0 = idle/running, 1 = ready, 2 = failed
+    DecodedTexture    result;
+    std::string       error;
+
+public:
+    ~AsyncTextureLoader() { if (worker.joinable()) worker.join(); }
+
+    void start(const std::string& imagePath, const std::string& cacheDir) {
+        state = 0;
+        worker = std::thread([this, imagePath, cacheDir] {
+            bool ok = loadTextureCached(imagePath, cacheDir, result, error);
+            state.store(ok ? 1 : 2, std::memory_order_release);
+        });
+    }
+
+    bool ready()  const { return state.load(std::memory_order_acquire) == 1; }
+    bool failed() const { return state.load(std::memory_order_acquire) == 2; }
+    const std::string& lastError() const { return error; }
+
+    DecodedTexture take() {
+        if (worker.joinable()) worker.join();
+        return std::move(result);
+    }
+};
@@ -0,0 +1,347 @@
+// tile_scheduler.h
+// Work-stealing job system for the CPU backend, with screen tiles as the
+// unit of work.
+//
+//   TileScheduler sched;                          // one worker per core
+//   TileFrame f = sched.submit(w, h, 64, [&](const TileRect& r, TileContext& ctx) {
+//       if (tooMuchWork(r)) { ctx.splitQuadrants(r); return; }
+//       draw(r);
+//   });
+//   ...                                           // caller is free meanwhile
+//   sched.wait(f);                                // helps until f is done
+//
+// Every worker owns a deque: it pops its own tasks from the back and, when
+// empty, steals from the front of a victim's deque, so thieves and owner
+// rarely touch the same end. Each deque has its own small lock; there is
+// no global queue. A tile with heavy geometry can split into sub-rectangles
+// that go to the current worker's deque, where idle workers steal them.
+//
+// Submission is barrier-free: submit() queues the tiles and returns, each
+// frame tracks its own outstanding-task count, and only wait() on that
+// frame blocks, so workers never stop between frames and several frames
+// may be in flight. Frames that write the same pixels must still be
+// waited on in order by the caller.
+//
+// Per-worker busy time, task and steal counts are kept for utilization
+// reports (printUtilization()).
+//
+// In steady state a frame allocates nothing: deques are ring buffers that
+// keep their capacity, frame records are recycled, and run() hands the
+// kernel over by reference.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Half-open pixel rectangle [x0,x1) x [y0,y1)
+struct TileRect {
+    int x0, y0, x1, y1;
+};
+
+class TileContext;
+typedef std::function<void(const TileRect&, TileContext&)> TileKernel;
+
+// One submitted frame: the kernel plus the number of tasks still to run
+struct TileFrameState {
+    TileKernel kernel;
+    std::atomic<int> remaining{0};
+    std::mutex doneMutex;
+    std::condition_variable done;
+};
+typedef std::shared_ptr<TileFrameState> TileFrame;
+
+class TileScheduler;
+
+// Handed to the kernel: which worker runs the tile, and a way to split it
+class TileContext {
+public:
+    int worker() const { return index; }   // 0..workerCount(); the last slot is the waiting caller
+
+    // Queue 'r' as a new task of the same frame
+    void split(const TileRect& r);
+
+    // Queue the four quadrants of 'r' (or its halves if one side is 1 pixel)
+    void splitQuadrants(const TileRect& r) {
+        int mx = (r.x0 + r.x1) / 2, my = (r.y0 + r.y1) / 2;
+        if (r.x1 - r.x0 < 2) mx = r.x1;
+        if (r.y1 - r.y0 < 2) my = r.y1;
+        const TileRect parts[4] = { { r.x0, r.y0, mx, my }, { mx, r.y0, r.x1, my },
+                                    { r.x0, my, mx, r.y1 }, { mx, my, r.x1, r.y1 } };
+        for (const TileRect& p : parts)
+            if (p.x0 < p.x1 && p.y0 < p.y1) split(p);
+    }
+
+private:
+    friend class TileScheduler;
+    TileContext(TileScheduler& s, const TileFrame& f, int i) : sched(s), frame(f), index(i) {}
+    TileScheduler& sched;
+    const TileFrame& frame;
+    int index;
+};
+
+class TileScheduler {
+public:
+    // 'threads' <= 0 means one worker per hardware thread
+    explicit TileScheduler(int threads = 0)
+        : queues(workerThreads(threads) + 1) {      // + the caller's slot used by wait()
+        threads = (int)queues.size() - 1;
+        for (int i = 0; i < threads; ++i)
+            workers.emplace_back([this, i] { workerLoop(i); });
+        resetStats();
+    }
+
+    ~TileScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    TileScheduler(const TileScheduler&) = delete;
+    TileScheduler& operator=(const TileScheduler&) = delete;
+
+    int workerCount() const { return (int)workers.size(); }
+
+    // Cover [0,width) x [0,height) with tile x tile rectangles and queue one
+    // task per tile. Returns at once; pass the result to wait(). Call from
+    // one thread at a time, like wait().
+    TileFrame submit(int width, int height, int tile, TileKernel kernel) {
+        TileFrame frame = recycledFrame();
+        frame->kernel = std::move(kernel);
+        int tilesX = (width + tile - 1) / tile, tilesY = (height + tile - 1) / tile;
+        int count = std::max(0, tilesX * tilesY);
+        frame->remaining = count;
+        if (!count) return frame;
+
+        // Contiguous runs of tiles per worker keep neighbouring tiles (and
+        // their cache lines) together; stealing evens out the rest.
+        int n = workerCount();
+        for (int w = 0; w < n; ++w) {
+            int begin = (int)((int64_t)count * w / n), end = (int)((int64_t)count * (w + 1) / n);
+            std::lock_guard<std::mutex> lock(queues[w].mutex);
+            for (int t = begin; t < end; ++t) {
+                int x = (t % tilesX) * tile, y = (t / tilesX) * tile;
+                queues[w].tasks.push_back({ frame, { x, y, std::min(x + tile, width), std::min(y + tile, height) } });
+            }
+        }
+        queued += count;
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_all();
+        return frame;
+    }
+
+    // Block until every task of 'frame' (splits included) has run. The
+    // calling thread executes queued tasks meanwhile instead of sleeping.
+    // Call from one thread at a time.
+    void wait(const TileFrame& frame) {
+        if (!frame) return;
+        const int self = workerCount();
+        Task t;
+        while (frame->remaining.load(std::memory_order_acquire) > 0) {
+            if (pop(self, t) || steal(self, t)) {
+                execute(t, self);
+                continue;
+            }
+            // Nothing left to take: the rest is running on workers
+            std::unique_lock<std::mutex> lock(frame->doneMutex);
+            frame->done.wait(lock, [&] { return frame->remaining.load(std::memory_order_acquire) == 0; });
+        }
+    }
+
+    // Submit and wait in one call. The kernel outlives the frame here, so
+    // it is passed by reference (no copy into a heap-allocated std::function).
+    template <class Kernel>
+    void run(int width, int height, int tile, const Kernel& kernel) {
+        TileFrame frame = submit(width, height, tile, TileKernel(std::cref(kernel)));
+        wait(frame);
+        frame->kernel = nullptr;
+    }
+
+    // === Utilization ===
+    struct WorkerStats {
+        double busyMs;       // time spent inside kernels
+        uint64_t tasks;      // tasks run
+        uint64_t steals;     // tasks taken from another worker's deque
+    };
+
+    void resetStats() {
+        for (Queue& q : queues) { q.busyNs = 0; q.ran = 0; q.steals = 0; }
+        statsStart = clock::now();
+    }
+
+    // One entry per worker; the last is the waiting caller
+    std::vector<WorkerStats> stats() const {
+        std::vector<WorkerStats> out;
+        for (const Queue& q : queues)
+            out.push_back({ q.busyNs.load() / 1e6, q.ran.load(), q.steals.load() });
+        return out;
+    }
+
+    // Busy time of each worker as a share of wall time since resetStats()
+    void printUtilization(const char* label) const {
+        double wallMs = std::chrono::duration<double, std::milli>(clock::now() - statsStart).count();
+        if (wallMs <= 0) return;
+        std::vector<WorkerStats> s = stats();
+        double busy = 0;
+        uint64_t tasks = 0, steals = 0;
+        for (size_t i = 0; i + 1 < s.size(); ++i) { busy += s[i].busyMs; tasks += s[i].tasks; steals += s[i].steals; }
+        printf("%s: %d workers, avg utilization %.1f%%, %llu tasks (%llu stolen), caller ran %llu\n",
+               label, workerCount(), 100.0 * busy / (wallMs * workerCount()),
+               (unsigned long long)tasks, (unsigned long long)steals, (unsigned long long)s.back().tasks);
+        for (size_t i = 0; i + 1 < s.size(); ++i)
+            printf("  worker %2zu: %5.1f%% busy, %llu tasks, %llu stolen\n", i, 100.0 * s[i].busyMs / wallMs,
+                   (unsigned long long)s[i].tasks, (unsigned long long)s[i].steals);
+    }
+
+private:
+    friend class TileContext;
+    typedef std::chrono::steady_clock clock;
+
+    struct Task {
+        TileFrame frame;
+        TileRect rect;
+    };
+
+    // Double-ended queue over a power-of-two ring; grows, never shrinks
+    class TaskRing {
+    public:
+        bool empty() const { return count == 0; }
+        Task& front() { return slots[head]; }
+        Task& back() { return slots[(head + count - 1) & (slots.size() - 1)]; }
+        void pop_front() { head = (head + 1) & (slots.size() - 1); --count; }
+        void pop_back() { --count; }
+        void push_back(Task t) {
+            if (count == slots.size()) {
+                std::vector<Task> bigger(std::max<size_t>(16, slots.size() * 2));
+                for (size_t i = 0; i < count; ++i) bigger[i] = std::move(slots[(head + i) & (slots.size() - 1)]);
+                slots.swap(bigger);
+                head = 0;
+            }
+            slots[(head + count++) & (slots.size() - 1)] = std::move(t);
+        }
+
+    private:
+        std::vector<Task> slots;
+        size_t head = 0, count = 0;
+    };
+
+    // Padded so the locks of neighbouring workers don't share a cache line
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        TaskRing tasks;
+        std::atomic<uint64_t> busyNs{0}, ran{0}, steals{0};
+    };
+
+    void push(int self, Task t) {
+        {
+            std::lock_guard<std::mutex> lock(queues[self].mutex);
+            queues[self].tasks.push_back(std::move(t));
+        }
+        queued.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_one();
+    }
+
+    // Owner end: newest first, so a split tile's pieces stay on this core
+    bool pop(int self, Task& out) {
+        Queue& q = queues[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        out = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        queued.fetch_sub(1);
+        return true;
+    }
+
+    // Thief end: oldest first, the biggest remaining chunk of work
+    bool steal(int self, Task& out) {
+        int n = (int)queues.size();
+        for (int k = 1; k < n; ++k) {
+            Queue& q = queues[(self + k) % n];
+            std::unique_lock<std::mutex> lock(q.mutex, std::try_to_lock);
+            if (!lock.owns_lock() || q.tasks.empty()) continue;
+            out = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            queued.fetch_sub(1);
+            queues[self].steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    // A frame record nobody else holds any more, or a new one. Frames are
+    // only submitted from one thread, so the pool needs no lock.
+    TileFrame recycledFrame() {
+        for (TileFrame& f : framePool)
+            if (f.use_count() == 1) {
+                std::atomic_thread_fence(std::memory_order_acquire);   // see the last owner's writes
+                return f;
+            }
+        framePool.push_back(std::make_shared<TileFrameState>());
+        return framePool.back();
+    }
+
+    static int workerThreads(int threads) {
+        return threads > 0 ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    void execute(Task& t, int self) {
+        auto start = clock::now();
+        {
+            TileContext ctx(*this, t.frame, self);
+            t.frame->kernel(t.rect, ctx);
+        }
+        Queue& q = queues[self];
+        q.busyNs.fetch_add((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count(),
+                           std::memory_order_relaxed);
+        q.ran.fetch_add(1, std::memory_order_relaxed);
+        if (t.frame->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(t.frame->doneMutex);
+            t.frame->done.notify_all();
+        }
+        t.frame.reset();
+    }
+
+    void workerLoop(int self) {
+        Task t;
+        for (;;) {
+            if (pop(self, t) || steal(self, t)) {
+                execute(t, self);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> workers;
+    std::vector<TileFrame> framePool;
+    std::atomic<int> queued{0};        // tasks sitting in any deque
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    clock::time_point statsStart;
+};
+
+inline void TileContext::split(const TileRect& r) {
+    frame->remaining.fetch_add(1, std::memory_order_relaxed);
+    sched.push(index, { frame, r });
+}
@@ -0,0 +1,67 @@
+// scene_convert.cpp
+// Converts a text scene (common/scene_stream.h, "Text form") into the
+// memory-mapped binary format read by scene_viewer.
+//
+//   ./scene_convert scenes/demo.txt demo.scn
+//   ./scene_convert --random 10000000 big.scn   // load-test scene
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include "common/scene_stream.h"
+
+// === Random Scene ===
+// n primitives spread over -100..100: lines, circles, ellipses, triangles
+void buildRandomScene(SceneBuilder& scene, size_t n) {
+    std::mt19937 rng(2025);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f), size(0.05f, 1.0f), unit(0.0f, 1.0f);
+    for (size_t i = 0; i < n; ++i) {
+        float x = pos(rng), y = pos(rng), s = size(rng);
+        uint32_t color = scenePackColor(unit(rng), unit(rng), unit(rng), 1.0f);
+        switch (i % 4) {
+          case 0: scene.line(x, y, x + s, y + size(rng), color); break;
+          case 1: scene.circle(x, y, s, color); break;
+          case 2: scene.ellipse(x, y, s, s * 0.5f, color); break;
+          case 3: {
+            float tri[6] = { x, y, x + s, y, x, y + s };
+            scene.polygon(tri, 3, color);
+            break;
+          }
+        }
+    }
+    scene.view[0] = -100; scene.view[1] = 100; scene.view[2] = -100; scene.view[3] = 100;
+    scene.hasView = true;
+}
+
+// === Main ===
+int main(int argc, char** argv) {
+    bool random = argc == 4 && std::string(argv[1]) == "--random";
+    if (argc != 3 && !random) {
+        std::cerr << "usage: " << argv[0] << " <scene.txt> <out.scn>\n"
+                  << "       " << argv[0] << " --random N <out.scn>\n";
+        return 1;
+    }
+    const char* outPath = argv[argc - 1];
+    auto start = std::chrono::steady_clock::now();
+    SceneBuilder scene;
+    std::string err;
+    if (random) {
+        buildRandomScene(scene, std::strtoull(argv[2], nullptr, 10));
+    } else {
+        // Batches are appended while the parser thread reads ahead
+        if (!streamSceneFile(argv[1], [&](const SceneBuilder& batch) { scene.append(batch); }, err)) {
+            std::cerr << err << "\n";
+            return 1;
+        }
+    }
+    if (!scene.write(outPath, err)) { std::cerr << err << "\n"; return 1; }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << outPath << ": " << scene.lineVertices.size() / 2 << " lines, "
+              << scene.circles.size() << " circles, " << scene.ellipses.size() << " ellipses, "
+              << scene.polygonFirst.size() << " polygons, " << scene.labels.size() << " labels ("
+              << ms << " ms)\n";
+    return 0;
+}
@@ -0,0 +1,157 @@
+#define GL_GLEXT_PROTOTYPES   // instanced circles and the SDF shader
+#include <GL/glut.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "common/headless.h"
+#include "common/instanced_circles.h"
+#include "common/frame_profiler.h"
+#include "common/scene_binary.h"
+#include "common/sdf_shapes.h"
+
+// Scene viewer: draws a binary scene (scene_binary.h) straight from its
+// memory mapping. Lines and polygon outlines are GL vertex arrays pointing
+// into the mapped file, circles are one instanced draw, ellipses are SDF
+// outlines (batched) and labels are bitmap text.
+//
+//   ./scene_convert scenes/demo.txt demo.scn && ./scene_viewer demo.scn
+
+static_assert(sizeof(SceneCircle) == sizeof(CircleInstance) &&
+              offsetof(SceneCircle, color) == offsetof(CircleInstance, tint),
+              "SceneCircle must match CircleInstance");
+static_assert(sizeof(SceneEllipse) == sizeof(SdfInstance) &&
+              offsetof(SceneEllipse, color) == offsetof(SdfInstance, color),
+              "SceneEllipse must match SdfInstance");
+
+// Globals ===
+MappedScene scene;
+InstancedCircleRenderer circleRenderer;
+SdfRenderer sdf;
+
+// === Initialization ===
+void init() {
+    glClearColor(1, 1, 1, 1);
+    SceneArray<SceneCircle> circles = scene.circles();
+    if (!circles.empty() && circleRenderer.init())
+        circleRenderer.upload(reinterpret_cast<const CircleInstance*>(circles.data), circles.size);
+    if (!scene.ellipses().empty()) sdf.init();
+}
+
+// === Window Resize / Projection ===
+void reshape(int w, int h) {
+    glViewport(0, 0, w, h);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    const float* v = scene.view();
+    glOrtho(v[0], v[1], v[2], v[3], -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+}
+
+// === Draw Vertex Arrays ===
+// Position and color come interleaved from the mapping; nothing is copied
+// on our side.
+void bindSceneVertices(const SceneVertex* v) {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(SceneVertex), &v->x);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(SceneVertex), &v->color);
+}
+
+void unbindSceneVertices() {
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void drawLines() {
+    PROFILE_SCOPE("drawLines");
+    SceneArray<SceneVertex> v = scene.lineVertices();
+    if (v.empty()) return;
+    bindSceneVertices(v.data);
+    glDrawArrays(GL_LINES, 0, (GLsizei)v.size);
+    unbindSceneVertices();
+}
+
+void drawPolygons() {
+    PROFILE_SCOPE("drawPolygons");
+    SceneArray<SceneVertex> v = scene.polygonVertices();
+    SceneArray<int32_t> first = scene.polygonFirst(), count = scene.polygonCount();
+    if (first.empty()) return;
+    bindSceneVertices(v.data);
+    glMultiDrawArrays(GL_LINE_LOOP, first.data, count.data, (GLsizei)first.size);
+    unbindSceneVertices();
+}
+
+void drawCircles() {
+    PROFILE_SCOPE("drawCircles");
+    circleRenderer.draw(0);
+}
+
+void drawEllipses() {
+    PROFILE_SCOPE("drawEllipses");
+    SceneArray<SceneEllipse> e = scene.ellipses();
+    sdf.drawBatch(reinterpret_cast<const SdfInstance*>(e.data), e.size, 1.0f);
+}
+
+void drawLabels() {
+    PROFILE_SCOPE("drawLabels");
+    for (const SceneLabel& l : scene.labels()) {
+        glColor4ub(l.color & 0xFF, (l.color >> 8) & 0xFF, (l.color >> 16) & 0xFF, l.color >> 24);
+        glRasterPos2f(l.x, l.y);
+        for (char c : scene.labelText(l))
+            bitmapCharacter(GLUT_BITMAP_HELVETICA_12, c);
+    }
+}
+
+// === Display Callback ===
+void display() {
+    PROFILE_SCOPE("display");
+    glClear(GL_COLOR_BUFFER_BIT);
+    glLoadIdentity();
+
+    // Filled circles underneath, outlines and text on top
+    drawCircles();
+    drawPolygons();
+    drawLines();
+    drawEllipses();
+    drawLabels();
+
+    PROFILE_FRAME_END();
+    presentFrame(false);
+}
+
+// === Main ===
+int main(int argc, char** argv) {
+    HeadlessOptions headless(800, 600);
+    bool offscreen = parseHeadlessArgs(argc, argv, headless);
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <scene.scn> [--headless ...]\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::string err;
+    if (!scene.open(argv[1], err)) {
+        std::cerr << err << "\n";
+        return 1;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << argv[1] << ": " << scene.lineVertices().size / 2 << " lines, "
+              << scene.circles().size << " circles, " << scene.ellipses().size << " ellipses, "
+              << scene.polygonFirst().size << " polygons, " << scene.labels().size
+              << " labels, mapped in " << ms << " ms\n";
+
+    if (offscreen)
+        return runHeadless(headless, init, reshape, display);
+
+    glutInit(&argc, argv);
+    glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
+    glutInitWindowSize(800, 600);
+    glutCreateWindow("Scene Viewer");
+
+    init();
+    glutReshapeFunc(reshape);
+    glutDisplayFunc(display);
+    glutMainLoop();
+    return 0;
+}
@@ -1,36 +1,183 @@
+#define GL_GLEXT_PROTOTYPES   // glGenBuffers & co. for the staging upload
 #include <GL/glut.h>
-#include <SOIL/SOIL.h>
+#include <GL/glx.h>
+#include <chrono>
 #include <cmath>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <random>
+#include "common/damage.h"
+#include "common/frame_arena.h"
+#include "common/headless.h"
+#include "common/instanced_circles.h"
+#include "common/sdf_shapes.h"
+#include "common/frame_profiler.h"
+#include "common/soft_raster.h"
+#include "common/stroke.h"
+#include "common/texture_cache.h"
 
 // Globals ===
 const float PI = 3.1415926f;
 bool bgIsGreen      = false; // false=blue, true=green
 bool fillIsTextured = false; // false=white, true=wood texture
 GLuint woodTexture;          // texture ID
+AsyncTextureLoader woodLoader;
+const char* TEXTURE_CACHE_DIR = ".texcache";
 
-//oad Texture ===
-void loadWoodTexture(const char* file) {
-    woodTexture = SOIL_load_OGL_texture(
-        file,
-        SOIL_LOAD_AUTO,
-        SOIL_CREATE_NEW_ID,
-        SOIL_FLAG_INVERT_Y
-    );
-    if (!woodTexture) {
-        std::cerr << "Failed to load " << file
-                  << ": " << SOIL_last_result() << "\n";
-        exit(1);
+// CPU backend (--cpu): shapes go through SoftContext instead of the driver
+bool cpuBackend = false;
+SoftContext soft;
+SoftTexture woodSoft;        // wood texels for the CPU backend
+int cpuThreads = 0;          // --threads N, 0 = one per core
+std::unique_ptr<TileScheduler> tileScheduler;
+
+// SDF mode (--sdf, key S): the circle is one quad shaded from its analytic
+// distance, anti-aliased, instead of a 361-vertex fan
+bool sdfMode = false;
+SdfRenderer sdfRenderer;
+
+// Marker overlay (--markers N): N small circles drawn with one instanced call
+std::vector<CircleInstance> markers;
+InstancedCircleRenderer markerRenderer;
+CircleBins markerBins;       // CPU backend tile bins, rebuilt on resize
+bool markerBinsValid = false;
+float markerBox[4];          // world bounds of all markers: x0 y0 x1 y1
+
+// Partial redraw: key presses report what they change, display() redraws
+// only that (scissor box on GL, dirty tiles on the CPU backend). The
+// background, grid and axes never change between G presses, so they are
+// rendered once into a cached layer that is copied back under the damage.
+const float VIEW[4] = { -10, 10, -10, 10 };   // l r b t, as in reshape()
+DamageTracker damage;
+TileMask dirtyTiles;         // CPU backend: SOFT_BIN tiles to redraw
+bool redrawRequested = false;
+bool layerValid = false;
+bool layerBgGreen = false;   // background the layer was built with
+GLuint layerFbo = 0, layerTex = 0;
+int layerWidth = 0, layerHeight = 0;
+SoftFramebuffer softLayer;   // CPU backend copy of the layer
+
+// Benchmark mode (--bench N): double-buffered, vsync off, idle-driven
+int benchFrames = 0;         // frames to render, 0 = interactive
+int benchDone   = 0;
+bool woodSettled = false;    // texture uploaded (or failed); bench waits for it
+FrameHistogram benchTimes;
+std::chrono::steady_clock::time_point benchLast;
+
+// === Placeholder Texture ===
+// Grey checkerboard shown until the worker thread has the wood decoded.
+void createPlaceholderTexture() {
+    unsigned char checker[8 * 8 * 4];
+    for (int y = 0; y < 8; ++y)
+      for (int x = 0; x < 8; ++x) {
+        unsigned char v = ((x ^ y) & 1) ? 200 : 120;
+        unsigned char* p = checker + (y * 8 + x) * 4;
+        p[0] = p[1] = p[2] = v; p[3] = 255;
+      }
+    glGenTextures(1, &woodTexture);
+    glBindTexture(GL_TEXTURE_2D, woodTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 8, 8, 0, GL_RGBA, GL_UNSIGNED_BYTE, checker);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+// === Upload Decoded Texture ===
+// Copy every mip level into one pixel-unpack (staging) buffer, then let
+// glTexImage2D source each level from an offset inside it. If the buffer
+// cannot be mapped (or its contents are lost on unmap), the levels are
+// uploaded straight from client memory instead.
+void uploadDecodedTexture(const DecodedTexture& tex) {
+    GLuint staging;
+    glGenBuffers(1, &staging);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, tex.dataSize(), nullptr, GL_STREAM_DRAW);
+    bool staged = false;
+    if (void* dst = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY)) {
+        std::memcpy(dst, tex.data(), tex.dataSize());
+        staged = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
     }
+    if (!staged) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
     glBindTexture(GL_TEXTURE_2D, woodTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (int i = 0; i < tex.levels(); ++i) {
+        const MipLevel& m = tex.level(i);
+        const char* offset = nullptr;
+        offset += m.offset - tex.dataOffset();
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA, m.width, m.height, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, staged ? (const void*)offset : tex.pixels(i));
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, tex.levels() - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glDeleteBuffers(1, &staging);
+
+    // Same mip chain for the CPU backend, trilinear like GL_LINEAR_MIPMAP_LINEAR
+    woodSoft.clear();
+    for (int i = 0; i < tex.levels(); ++i) {
+        const MipLevel& m = tex.level(i);
+        woodSoft.addLevel(reinterpret_cast<const uint32_t*>(tex.pixels(i)), m.width, m.height);
+    }
+    woodSoft.filter = SoftFilter::Trilinear;
+}
+
+// === Damage ===
+// What each change repaints, in pixels (see damage.h)
+void damageCircle() { damage.addWorld(VIEW, -3.0f - 4.0f, 1.0f - 4.0f, -3.0f + 4.0f, 1.0f + 4.0f); }
+void damageMarkers() {
+    if (!markers.empty()) damage.addWorld(VIEW, markerBox[0], markerBox[1], markerBox[2], markerBox[3]);
+}
+
+// Redisplay with the damage reported so far. A redisplay GLUT issues on
+// its own (expose, first show) comes without this flag and repaints
+// everything.
+void requestRedraw() {
+    redrawRequested = true;
+    glutPostRedisplay();
+}
+
+// === Poll Texture Loader (GLUT timer) ===
+void pollWoodTexture(int) {
+    if (woodLoader.ready()) {
+        DecodedTexture tex = woodLoader.take();
+        uploadDecodedTexture(tex);
+        woodSettled = true;
+        if (fillIsTextured) { damageCircle(); damageMarkers(); }
+        requestRedraw();
+    } else if (woodLoader.failed()) {
+        // Keep the placeholder rather than killing the demo
+        std::cerr << "Failed to load wood.jpg: " << woodLoader.lastError() << "\n";
+        woodSettled = true;
+    } else {
+        glutTimerFunc(16, pollWoodTexture, 0);
+    }
 }
 
 // === Initialization ===
 void init() {
     glEnable(GL_TEXTURE_2D);
-    loadWoodTexture("wood.jpg");  // make sure wood.jpg is in the same folder
+    createPlaceholderTexture();
+    if (!cpuBackend && !sdfRenderer.init()) sdfMode = false;
+    if (!markers.empty() && !cpuBackend) {
+        if (markerRenderer.init()) markerRenderer.upload(markers);
+        else markers.clear();
+    }
+    if (headlessActive()) {
+        // No GLUT timers offscreen, so load synchronously (still via the cache)
+        DecodedTexture tex;
+        std::string err;
+        if (loadTextureCached("wood.jpg", TEXTURE_CACHE_DIR, tex, err))
+            uploadDecodedTexture(tex);
+        else
+            std::cerr << "Failed to load wood.jpg: " << err << "\n";
+        return;
+    }
+    // make sure wood.jpg is in the same folder; decoded copies go to .texcache/
+    woodLoader.start("wood.jpg", TEXTURE_CACHE_DIR);
+    glutTimerFunc(16, pollWoodTexture, 0);
 }
 
 // === Window Resize / Projection ===
@@ -41,99 +188,336 @@ void reshape(int w, int h) {
     // world coords from -10..+10 in X and Y
     glOrtho(-10, 10, -10, 10, -1, 1);
     glMatrixMode(GL_MODELVIEW);
+
+    soft.viewport(w, h);
+    soft.ortho(-10, 10, -10, 10);
+    damage.resize(w, h);
+    layerValid = false;
+    markerBinsValid = false;
+}
+
+// === Backend Dispatch ===
+// The draw functions below issue these instead of raw gl* calls, so the
+// same code renders through GL or through the CPU rasterizer.
+void beginShape(GLenum mode)           { if (cpuBackend) soft.begin(mode); else glBegin(mode); }
+void endShape()                        { if (cpuBackend) soft.end(); else glEnd(); }
+void vertex(float x, float y)          { if (cpuBackend) soft.vertex2f(x, y); else glVertex2f(x, y); }
+void texCoord(float u, float v)        { if (cpuBackend) soft.texCoord2f(u, v); else glTexCoord2f(u, v); }
+void color(float r, float g, float b)  { if (cpuBackend) soft.color3f(r, g, b); else glColor3f(r, g, b); }
+void drawMesh(const StrokeMesh& m) {
+    if (cpuBackend) {
+        soft.begin(GL_TRIANGLES);
+        for (uint32_t i : m.indices) soft.vertex2f(m.vertices[i].x, m.vertices[i].y);
+        soft.end();
+    } else {
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glVertexPointer(2, GL_FLOAT, 0, m.vertices.data());
+        glDrawElements(GL_TRIANGLES, (GLsizei)m.indices.size(), GL_UNSIGNED_INT, m.indices.data());
+        glDisableClientState(GL_VERTEX_ARRAY);
+    }
+}
+void useWoodTexture(bool on) {
+    if (cpuBackend) {
+        soft.bindTexture(on && !woodSoft.empty() ? &woodSoft : nullptr);
+    } else if (on) {
+        glEnable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, woodTexture);
+    } else {
+        glDisable(GL_TEXTURE_2D);
+    }
 }
 
 // === Draw Grid & Axes ===
+// Stroked on the CPU (1 px grid, 2 px axes) so the widths do not depend
+// on the driver; rebuilt only when the window size changes.
+StrokeMesh gridStroke, axesStroke;
+
 void drawGrid() {
+    PROFILE_SCOPE("drawGrid");
+    const int size[2] = { soft.fb.width, soft.fb.height };
+    uint64_t key = strokeHash(size, sizeof(size));
+    float px = size[0] / 20.0f, py = size[1] / 20.0f;
+
     // Light‑gray grid lines
-    glLineWidth(1);
-    glColor3f(0.8f, 0.8f, 0.8f);
-    glBegin(GL_LINES);
-      for (int i = -10; i <= 10; ++i) {
-        // vertical
-        glVertex2f(i, -10); glVertex2f(i, 10);
-        // horizontal
-        glVertex2f(-10, i); glVertex2f(10, i);
-      }
-    glEnd();
+    if (gridStroke.begin(StrokeStyle{ 1.0f }, key)) {
+        gridStroke.setPixelScale(px, py);
+        for (int i = -10; i <= 10; ++i) {
+            gridStroke.addSegment(i, -10, i, 10);   // vertical
+            gridStroke.addSegment(-10, i, 10, i);   // horizontal
+        }
+        gridStroke.end();
+    }
+    color(0.8f, 0.8f, 0.8f);
+    drawMesh(gridStroke);
 
     // White axes
-    glLineWidth(2);
-    glColor3f(1, 1, 1);
-    glBegin(GL_LINES);
-      // Y axis
-      glVertex2f(0, -10); glVertex2f(0, 10);
-      // X axis
-      glVertex2f(-10, 0); glVertex2f(10, 0);
-    glEnd();
+    if (axesStroke.begin(StrokeStyle{ 2.0f }, key)) {
+        axesStroke.setPixelScale(px, py);
+        axesStroke.addSegment(0, -10, 0, 10);   // Y axis
+        axesStroke.addSegment(-10, 0, 10, 0);   // X axis
+        axesStroke.end();
+    }
+    color(1, 1, 1);
+    drawMesh(axesStroke);
+}
+
+// === Draw SDF Circle ===
+// White circle, optionally wood-textured, as a single anti-aliased quad.
+void drawSdfCircle(float cx, float cy, float r, bool textured) {
+    PROFILE_SCOPE("drawSdfCircle");
+    SdfShape shape = { cx, cy, r, r, 0.0f };
+    if (cpuBackend) {
+        soft.flush();   // blend over the grid already queued
+        const SoftTexture* tex = textured && !woodSoft.empty() ? &woodSoft : nullptr;
+        SoftOrtho view = { -10, 10, -10, 10 };
+        tileScheduler->run(soft.fb.width, soft.fb.height, SOFT_BIN, [&](const SoftRect& r, TileContext&) {
+            if (dirtyTiles.touches(r)) rasterSdfShape(soft.fb, shape, packRGBA(1, 1, 1, 1), tex, view, r);
+        });
+    } else {
+        glDisable(GL_TEXTURE_2D);
+        glColor3f(1.0f, 1.0f, 1.0f);
+        sdfRenderer.draw(shape, textured ? woodTexture : 0);
+    }
 }
 
 // === Draw Solid (white) Circle ===
 void drawSolidCircle(float cx, float cy, float r) {
-    glDisable(GL_TEXTURE_2D);
-    glColor3f(1.0f, 1.0f, 1.0f); // white
-    glBegin(GL_TRIANGLE_FAN);
-      glVertex2f(cx, cy);
+    PROFILE_SCOPE("drawSolidCircle");
+    useWoodTexture(false);
+    color(1.0f, 1.0f, 1.0f); // white
+    beginShape(GL_TRIANGLE_FAN);
+      vertex(cx, cy);
       for (int a = 0; a <= 360; ++a) {
         float rad = a * PI / 180.0f;
-        glVertex2f(cx + r * cos(rad), cy + r * sin(rad));
+        vertex(cx + r * cos(rad), cy + r * sin(rad));
       }
-    glEnd();
+    endShape();
 }
 
 // === Draw Textured Circle ===
 void drawTexturedCircle(float cx, float cy, float r) {
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, woodTexture);
-    glBegin(GL_TRIANGLE_FAN);
+    PROFILE_SCOPE("drawTexturedCircle");
+    useWoodTexture(true);
+    color(1.0f, 1.0f, 1.0f);
+    beginShape(GL_TRIANGLE_FAN);
       // center
-      glTexCoord2f(0.5f, 0.5f);
-      glVertex2f(cx, cy);
+      texCoord(0.5f, 0.5f);
+      vertex(cx, cy);
       // rim
       for (int a = 0; a <= 360; ++a) {
         float rad = a * PI / 180.0f;
         float x = cx + r * cos(rad), y = cy + r * sin(rad);
         float u = (cos(rad) + 1.0f) * 0.5f;
         float v = (sin(rad) + 1.0f) * 0.5f;
-        glTexCoord2f(u, v);
-        glVertex2f(x, y);
+        texCoord(u, v);
+        vertex(x, y);
       }
-    glEnd();
+    endShape();
+    useWoodTexture(false);
+}
+
+// === Marker Overlay ===
+// Deterministic scatter of small tinted circles over the whole view.
+void createMarkers(int count) {
+    std::mt19937 rng(2025);
+    std::uniform_real_distribution<float> pos(-10.0f, 10.0f), radius(0.05f, 0.3f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f), bright(0.5f, 1.0f);
+    markers.resize(count);
+    for (CircleInstance& m : markers) {
+        m.cx = pos(rng); m.cy = pos(rng); m.radius = radius(rng);
+        m.texOffsetU = unit(rng); m.texOffsetV = unit(rng);
+        m.tint = packRGBA(bright(rng), bright(rng), bright(rng), 1.0f);
+    }
+    markerBox[0] = markerBox[1] = 1e30f;
+    markerBox[2] = markerBox[3] = -1e30f;
+    for (const CircleInstance& m : markers) {
+        markerBox[0] = std::min(markerBox[0], m.cx - m.radius); markerBox[1] = std::min(markerBox[1], m.cy - m.radius);
+        markerBox[2] = std::max(markerBox[2], m.cx + m.radius); markerBox[3] = std::max(markerBox[3], m.cy + m.radius);
+    }
+}
+
+void drawMarkers() {
+    PROFILE_SCOPE("drawMarkers");
+    if (markers.empty()) return;
+    if (cpuBackend) {
+        soft.flush();   // markers go on top of everything queued so far
+        const SoftTexture* tex = fillIsTextured && !woodSoft.empty() ? &woodSoft : nullptr;
+        SoftOrtho view = { -10, 10, -10, 10 };
+        if (!markerBinsValid) binCircleInstances(markers, soft.fb, view, markerBins);
+        markerBinsValid = true;
+        rasterCircleBins(soft.fb, markers, markerBins, tex, view, tileScheduler.get(), &dirtyTiles);
+    } else {
+        markerRenderer.draw(fillIsTextured ? woodTexture : 0);
+    }
+}
+
+// === Static Layer ===
+// Background, grid and axes into an offscreen framebuffer, rebuilt when
+// the background or the window size changes. Without framebuffer objects
+// the layer is simply redrawn under the scissor every frame.
+void buildGlLayer(int w, int h) {
+    PROFILE_SCOPE("buildGlLayer");
+    GLint prevFbo = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevFbo);
+    if (!layerFbo || layerWidth != w || layerHeight != h) {
+        if (!layerTex) glGenTextures(1, &layerTex);
+        glBindTexture(GL_TEXTURE_2D, layerTex);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        if (!layerFbo) glGenFramebuffers(1, &layerFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, layerFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, layerTex, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+            glDeleteFramebuffers(1, &layerFbo);
+            glDeleteTextures(1, &layerTex);
+            layerFbo = layerTex = 0;
+            return;
+        }
+        layerWidth = w; layerHeight = h;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, layerFbo);
+    glDisable(GL_SCISSOR_TEST);
+    glClear(GL_COLOR_BUFFER_BIT);
+    useWoodTexture(false);
+    drawGrid();
+    glEnable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, prevFbo);
+    layerValid = true;
+    layerBgGreen = bgIsGreen;
+}
+
+// Copy the layer back under the scissor box 'r'
+void restoreGlLayer(const TileRect& r) {
+    PROFILE_SCOPE("restoreGlLayer");
+    GLint prevRead = 0;
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &prevRead);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, layerFbo);
+    glBlitFramebuffer(r.x0, r.y0, r.x1, r.y1, r.x0, r.y0, r.x1, r.y1, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, prevRead);
+}
+
+// CPU backend: the software framebuffer itself is the layer's source
+void buildSoftLayer() {
+    PROFILE_SCOPE("buildSoftLayer");
+    soft.clear();
+    drawGrid();
+    soft.flush();
+    softLayer = soft.fb;
+    layerValid = true;
+    layerBgGreen = bgIsGreen;
+}
+
+void restoreSoftLayer() {
+    PROFILE_SCOPE("restoreSoftLayer");
+    if (damage.isFull()) {
+        soft.fb.pixels = softLayer.pixels;
+        return;
+    }
+    for (int ty = 0; ty < dirtyTiles.tilesY; ++ty)
+        for (int tx = 0; tx < dirtyTiles.tilesX; ++tx)
+            if (dirtyTiles.test(tx, ty))
+                soft.fb.copyRect(softLayer, { tx * SOFT_BIN, ty * SOFT_BIN, (tx + 1) * SOFT_BIN, (ty + 1) * SOFT_BIN });
+}
+
+// === Present CPU Frame ===
+// Copy the damaged part of the software framebuffer into the GL window;
+// text is drawn on top by GL.
+void presentSoftFrame() {
+    PROFILE_SCOPE("presentSoftFrame");
+    soft.flush();
+    glDisable(GL_TEXTURE_2D);
+    if (damage.isFull()) {
+        glWindowPos2i(0, 0);
+        glDrawPixels(soft.fb.width, soft.fb.height, GL_RGBA, GL_UNSIGNED_BYTE, soft.fb.pixels.data());
+        return;
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, soft.fb.width);
+    auto draw = [](const TileRect& r) {
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, r.x0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, r.y0);
+        glWindowPos2i(r.x0, r.y0);
+        glDrawPixels(r.x1 - r.x0, r.y1 - r.y0, GL_RGBA, GL_UNSIGNED_BYTE, soft.fb.pixels.data());
+    };
+    for (const TileRect& r : damage.regions()) draw(r);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
 }
 
 // === On‑screen Text ===
 void drawText(const char* s, float x, float y) {
+    PROFILE_SCOPE("drawText");
     glDisable(GL_TEXTURE_2D);
     glColor3f(1, 1, 1);
     glRasterPos2f(x, y);
     for (const char* c = s; *c; ++c)
-        glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+        bitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
 }
 
 // === Display Callback ===
 void display() {
+    PROFILE_SCOPE("display");
     // 1) background color
-    if (bgIsGreen) glClearColor(0,1,0,1);
-    else           glClearColor(0,0,0.5f,1); // dark blue
+    if (bgIsGreen) { glClearColor(0,1,0,1);    soft.clearColor(0,1,0,1); }
+    else           { glClearColor(0,0,0.5f,1); soft.clearColor(0,0,0.5f,1); } // dark blue
 
-    glClear(GL_COLOR_BUFFER_BIT);
+    // Double buffering leaves the back buffer undefined after a swap, and a
+    // redisplay we did not ask for may be an expose: both repaint everything
+    if (benchFrames > 0 || !redrawRequested) damage.addAll();
+    // The layer holds the clear color: rebuild it when the background
+    // changed, whoever changed it (G key or the benchmark cycle)
+    if (layerValid && layerBgGreen != bgIsGreen) {
+        layerValid = false;
+        damage.addAll();
+    }
+    redrawRequested = false;
+    damage.buildTileMask(dirtyTiles, SOFT_BIN);
+    TileRect box = damage.bounds();
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(box.x0, box.y0, std::max(0, box.x1 - box.x0), std::max(0, box.y1 - box.y0));
     glLoadIdentity();
 
-    // 2) grid + axes
-    drawGrid();
+    // 2) grid + axes, from the cached layer
+    if (cpuBackend) {
+        if (!layerValid) buildSoftLayer();
+        else restoreSoftLayer();
+        soft.setTileMask(damage.isFull() ? nullptr : &dirtyTiles);
+    } else {
+        if (!layerValid) buildGlLayer(soft.fb.width, soft.fb.height);
+        if (layerFbo) {
+            restoreGlLayer(box);
+        } else {
+            glClear(GL_COLOR_BUFFER_BIT);
+            drawGrid();
+        }
+    }
 
     // 3) circle at (-3,1), radius=4 cm → 4 units
-    if (fillIsTextured)
+    if (sdfMode)
+        drawSdfCircle(-3.0f, 1.0f, 4.0f, fillIsTextured);
+    else if (fillIsTextured)
         drawTexturedCircle(-3.0f, 1.0f, 4.0f);
     else
         drawSolidCircle(     -3.0f, 1.0f, 4.0f);
+    drawMarkers();
+
+    if (cpuBackend) {
+        presentSoftFrame();
+        soft.setTileMask(nullptr);
+    }
 
     // 4) UI text
     drawText("G: Toggle BG (Blue/Green)", -9.5f,  9.0f);
     drawText("T: Toggle Fill (White/Wood)", -9.5f,  8.0f);
-    drawText("Circle @ (-3,1), r=4cm",      -9.5f,  7.0f);
+    drawText("S: Toggle SDF (Fan/Quad)",    -9.5f,  7.0f);
+    drawText("Circle @ (-3,1), r=4cm",      -9.5f,  6.0f);
+    glDisable(GL_SCISSOR_TEST);
+    damage.clear();
 
-    glFlush();
+    FRAME_ARENA_END();
+    PROFILE_FRAME_END();
+    presentFrame(benchFrames > 0);
 }
 
 // === Keyboard Callback ===
@@ -141,20 +525,89 @@ void keyboard(unsigned char key, int x, int y) {
     switch (key) {
       case 'g': case 'G':
         bgIsGreen = !bgIsGreen;
+        layerValid = false;   // the background is under everything
+        damage.addAll();
         break;
       case 't': case 'T':
         fillIsTextured = !fillIsTextured;
+        damageCircle();
+        damageMarkers();      // their texture follows the fill
+        break;
+      case 's': case 'S':
+        sdfMode = !sdfMode && (cpuBackend || sdfRenderer.ready());
+        damageCircle();
         break;
       case 27: // ESC
         exit(0);
     }
-    glutPostRedisplay();
+    requestRedraw();
+}
+
+// === Benchmark Loop ===
+// Turn off vsync so frame times measure rendering, not the display refresh.
+void disableVsync() {
+    typedef void (*SwapIntervalEXT)(Display*, GLXDrawable, int);
+    typedef int  (*SwapIntervalMESA)(unsigned int);
+    if (auto ext = (SwapIntervalEXT)glXGetProcAddress((const GLubyte*)"glXSwapIntervalEXT"))
+        ext(glXGetCurrentDisplay(), glXGetCurrentDrawable(), 0);
+    else if (auto mesa = (SwapIntervalMESA)glXGetProcAddress((const GLubyte*)"glXSwapIntervalMESA"))
+        mesa(0);
+}
+
+// Idle callback: one frame per call, cycling the four bg/fill states.
+// Frame time is swap-to-swap with glFinish, so queued GPU work is counted.
+void benchIdle() {
+    if (!woodSettled) return;   // don't time the placeholder texture
+    bgIsGreen      = benchDone & 1;
+    fillIsTextured = (benchDone >> 1) & 1;
+    display();
+    glFinish();
+
+    auto now = std::chrono::steady_clock::now();
+    if (benchDone > 0)
+        benchTimes.add(std::chrono::duration<double, std::milli>(now - benchLast).count());
+    benchLast = now;
+
+    if (++benchDone > benchFrames) {   // one extra frame: the first has no predecessor
+        benchTimes.print(cpuBackend ? "Benchmark (CPU backend)" : "Benchmark (GL)");
+        if (tileScheduler) tileScheduler->printUtilization("CPU workers");
+        exit(0);
+    }
 }
 
 // === Main ===
 int main(int argc, char** argv) {
+    // --cpu: rasterize shapes on the CPU (soft_raster.h) instead of the driver
+    // --bench N: render N frames as fast as possible and print frame-time stats
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--cpu") cpuBackend = true;
+        // --sdf: start in SDF mode (one anti-aliased quad per circle)
+        if (std::string(argv[i]) == "--sdf") sdfMode = true;
+        // --threads N: CPU backend worker count (default: all cores)
+        if (std::string(argv[i]) == "--threads" && i + 1 < argc) cpuThreads = std::max(0, atoi(argv[i + 1]));
+        if (std::string(argv[i]) == "--bench" && i + 1 < argc) benchFrames = std::max(1, atoi(argv[i + 1]));
+        // --markers N: overlay N instanced circles (thousands to millions)
+        if (std::string(argv[i]) == "--markers" && i + 1 < argc) createMarkers(std::max(0, atoi(argv[i + 1])));
+    }
+
+    if (cpuBackend) {
+        tileScheduler.reset(new TileScheduler(cpuThreads));
+        soft.setScheduler(tileScheduler.get());
+    }
+
+    HeadlessOptions headless(800, 600);
+    if (parseHeadlessArgs(argc, argv, headless)) {
+        int rc = runHeadless(headless, init, reshape, display);
+        if (tileScheduler) tileScheduler->printUtilization("CPU workers");
+        return rc;
+    }
+
+    if (benchFrames) {
+        setenv("vblank_mode", "0", 0);            // Mesa
+        setenv("__GL_SYNC_TO_VBLANK", "0", 0);    // NVIDIA
+    }
     glutInit(&argc, argv);
-    glutInitDisplayMode(GLUT_SINGLE | GLUT_RGB);
+    glutInitDisplayMode((benchFrames ? GLUT_DOUBLE : GLUT_SINGLE) | GLUT_RGB);
     glutInitWindowSize(800, 600);
     glutCreateWindow("Circle Demo with Grid & UI");
 
@@ -162,6 +615,10 @@ int main(int argc, char** argv) {
     glutReshapeFunc(reshape);
     glutDisplayFunc(display);
     glutKeyboardFunc(keyboard);
+    if (benchFrames) {
+        disableVsync();
+        glutIdleFunc(benchIdle);
+    }
     glutMainLoop();
     return 0;
 }